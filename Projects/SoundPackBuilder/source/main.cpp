@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "SoundTools/SoundPackBuilder.h"
+#include "SoundTools/WaveBuffer.h"
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::cout <<
+			"Usage: SoundPackBuilder [-e pcm16|mulaw|ima|msadpcm] <output pack> <wave files...>" << std::endl <<
+			"Sounds are named by their paths as given, with forward slashes." << std::endl;
+	}
+
+	bool ParseEncoding(const char* name, SampleEncoding& encoding)
+	{
+		if (std::strcmp(name, "pcm16") == 0) encoding = SampleEncoding::Pcm;
+		else if (std::strcmp(name, "mulaw") == 0) encoding = SampleEncoding::MuLaw;
+		else if (std::strcmp(name, "ima") == 0) encoding = SampleEncoding::ImaAdpcm;
+		else if (std::strcmp(name, "msadpcm") == 0) encoding = SampleEncoding::MsAdpcm;
+		else return false;
+
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int arg = 1;
+	bool encode = false;
+	SampleEncoding encoding = SampleEncoding::Pcm;
+
+	if (arg + 1 < argc && std::strcmp(argv[arg], "-e") == 0)
+	{
+		if (!ParseEncoding(argv[arg + 1], encoding))
+		{
+			PrintUsage();
+			return 1;
+		}
+
+		encode = true;
+		arg += 2;
+	}
+
+	if (argc - arg < 2)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const char* output = argv[arg++];
+
+	try
+	{
+		SoundPackBuilder builder;
+
+		for (; arg < argc; ++arg)
+		{
+			std::string name = argv[arg];
+			std::replace(name.begin(), name.end(), '\\', '/');
+
+			// Mapped, so unencoded sources are not copied into memory
+			WaveBuffer wave(argv[arg], WaveBufferStorage::Mapped);
+			builder.Add(name.c_str(), encode ? wave.Encode(encoding) : std::move(wave));
+		}
+
+		builder.Save(output);
+		std::cout << "Packed " << builder.GetSoundsCount() << " sounds to " << output << std::endl;
+	}
+	catch (const std::exception& ex)
+	{
+		std::cout << "Error: " << ex.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
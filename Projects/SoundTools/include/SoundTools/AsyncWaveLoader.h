@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+
+#include "Common.h"
+#include "WaveBuffer.h"
+
+// wave is null when the file couldn't be loaded, error then tells why
+using WaveLoadCallback = std::function<void(std::unique_ptr<WaveBuffer> wave, const char* error)>;
+
+// Loads wave files without blocking the caller. Many reads are kept in flight at once,
+// overlapped I/O on Windows and a pread thread pool elsewhere, which is what slow
+// and network-mounted volumes need to approach their throughput.
+class SOUND_TOOLS_API AsyncWaveLoader
+{
+public:
+	// queueDepth is the number of reads in flight across all files, chunkSize the size of each
+	AsyncWaveLoader(size_t queueDepth = 32, size_t chunkSize = 256 * 1024);
+	AsyncWaveLoader(const AsyncWaveLoader&) = delete;
+	// Waits for the reads in flight, files not read yet are dropped without their callbacks
+	~AsyncWaveLoader();
+
+	// Callbacks are called from an I/O thread
+	void Load(const char* filename, WaveLoadCallback onLoaded);
+	std::future<WaveBuffer> Load(const char* filename);
+
+	AsyncWaveLoader& operator=(const AsyncWaveLoader&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "SoundBackend.h"
+
+// Accepts and discards any number of frames, for headless runs and profiling the mixer
+class SOUND_TOOLS_API NullSoundBackend : public SoundBackend
+{
+public:
+	NullSoundBackend();
+
+	size_t GetWritableFrames() override;
+	void Write(const float* frames, size_t framesCount) override;
+
+	size_t GetWrittenFrames() const;
+
+private:
+	size_t m_writtenFrames;
+};
\ No newline at end of file
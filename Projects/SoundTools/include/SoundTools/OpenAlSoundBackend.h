@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+
+#include "SoundBackend.h"
+
+// Plays the mix through one streaming source of the current OpenAL context.
+// Writable frames are the free space of a small ring of queued buffers.
+class SOUND_TOOLS_API OpenAlSoundBackend : public SoundBackend
+{
+public:
+	OpenAlSoundBackend(
+		size_t channelsCount,
+		size_t sampleRate,
+		size_t blockFrames = 1024,
+		size_t buffersCount = 4);
+	OpenAlSoundBackend(const OpenAlSoundBackend&) = delete;
+	~OpenAlSoundBackend();
+
+	size_t GetWritableFrames() override;
+	void Write(const float* frames, size_t framesCount) override;
+
+	OpenAlSoundBackend& operator=(const OpenAlSoundBackend&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
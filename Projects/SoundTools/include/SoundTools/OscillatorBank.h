@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "Common.h"
+#include "WaveBuffer.h"
+
+enum class Waveform
+{
+	Sine,
+	Square,
+	Saw,
+	Triangle,
+	Noise
+};
+
+// Phase-accumulator oscillators summed into one mono signal.
+// Sine reads a table generated at compile time, the other shapes are computed
+// from the phase, and blocks of four samples are produced with SIMD where available.
+class SOUND_TOOLS_API OscillatorBank
+{
+public:
+	OscillatorBank(size_t sampleRate);
+	OscillatorBank(const OscillatorBank&) = delete;
+	~OscillatorBank();
+
+	// Frequencies are clamped to the Nyquist limit. Returns the oscillator index.
+	size_t Add(Waveform waveform, float frequency, float amplitude = 1);
+	void SetFrequency(size_t oscillator, float frequency);
+	void SetAmplitude(size_t oscillator, float amplitude);
+	void Clear();
+
+	size_t GetSampleRate() const;
+	size_t GetOscillatorsCount() const;
+
+	// Writes the next count samples of the sum, 16-bit output is clamped
+	void Generate(float* out, size_t count);
+	void Generate(int16_t* out, size_t count);
+
+	// Renders the next duration seconds as 16-bit PCM or 32-bit float
+	WaveBuffer MakeWaveBuffer(float duration, size_t bitsPerSample = 16);
+
+	OscillatorBank& operator=(const OscillatorBank&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
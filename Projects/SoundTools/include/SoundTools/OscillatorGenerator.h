@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+
+#include "OscillatorBank.h"
+#include "SoundGenerator.h"
+
+// Streams an OscillatorBank, endlessly or for a fixed duration
+class SOUND_TOOLS_API OscillatorGenerator : public SoundGenerator
+{
+public:
+	// A zero duration never ends. Output is 16-bit PCM or 32-bit float.
+	OscillatorGenerator(size_t sampleRate, float duration = 0, size_t bitsPerSample = 16);
+	OscillatorGenerator(const OscillatorGenerator&) = delete;
+	~OscillatorGenerator();
+
+	// Set the oscillators up before the generator is handed to a source
+	OscillatorBank& GetBank();
+
+	SoundRenderFormat GetFormat() const override;
+	void Rewind() override;
+	size_t Generate(void* data, size_t size) override;
+
+	OscillatorGenerator& operator=(const OscillatorGenerator&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+enum class SampleEncoding
+{
+	// Unsigned 8-bit or signed 16/24/32-bit little-endian integers
+	Pcm,
+	// 32 or 64-bit IEEE floating point
+	Float,
+	// G.711 mu-law, 8 bits per sample
+	MuLaw,
+	// 4 bits per sample in blocks that start with a header per channel
+	ImaAdpcm,
+	MsAdpcm
+};
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "Common.h"
+#include "OscillatorBank.h"
+#include "SoundGenerator.h"
+#include "SoundMixerClip.h"
+#include "WaveBuffer.h"
+
+constexpr size_t sequencerTracksCount = 16;
+
+// Renders timestamped events so that each one takes effect exactly on the frame of its time,
+// however late the rendering thread runs. Times are seconds on the sequencer clock, which
+// advances only as frames are rendered. Notes are synthesized, clips are mixed in software.
+// Events may be scheduled from any thread, rendering happens on one.
+class SOUND_TOOLS_API Sequencer : public SoundGenerator
+{
+public:
+	// Output is 16-bit PCM or 32-bit float. An endless sequencer outputs silence after
+	// the last event instead of ending, for events scheduled while it plays.
+	Sequencer(
+		size_t channelsCount, size_t sampleRate,
+		size_t bitsPerSample = 16,
+		bool endless = false,
+		size_t polyphony = 32);
+	Sequencer(const Sequencer&) = delete;
+	~Sequencer();
+
+	// Keys are MIDI note numbers, 69 is A4 at 440 Hz.
+	// Events with a time already rendered play at the start of the next block.
+	void NoteOn(double time, size_t track, uint8_t key, float velocity = 1, Waveform waveform = Waveform::Sine);
+	void NoteOff(double time, size_t track, uint8_t key);
+	void PlayClip(double time, size_t track, std::shared_ptr<const SoundMixerClip> clip, float gain = 1, float pitch = 1);
+	// Scale everything on the track, including notes and clips already playing
+	void SetTrackGain(double time, size_t track, float gain);
+	void SetTrackPitch(double time, size_t track, float pitch);
+
+	// Schedules a score file with its times offset by time. Scores are text,
+	// one command per line, # starts a comment:
+	//   tempo <bpm>                        times of the following lines are beats, seconds by default
+	//   clip <name> <wave file>            the path is relative to the score
+	//   <time> on <track> <key> [velocity] [waveform]
+	//   <time> off <track> <key>
+	//   <time> note <track> <key> <length> [velocity] [waveform]
+	//   <time> play <track> <clip name> [gain] [pitch]
+	//   <time> gain <track> <gain>
+	//   <time> pitch <track> <pitch>
+	// Waveforms are sine, square, saw, triangle and noise.
+	void LoadScore(const char* filename, double time = 0);
+
+	// Seconds rendered so far, live events should be scheduled some latency ahead of it
+	double GetTime() const;
+
+	SoundRenderFormat GetFormat() const override;
+	// Silences all voices and restarts the clock, replaying the score.
+	// Endless sequencers drop events once played, so they only restart the clock.
+	void Rewind() override;
+	size_t Generate(void* data, size_t size) override;
+
+	// Renders from the current time until the last voice ends
+	WaveBuffer MakeWaveBuffer();
+
+	Sequencer& operator=(const Sequencer&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Common.h"
+
+// Output of SoundMixer. Frames are interleaved floats in the mixer's channel layout and rate.
+class SOUND_TOOLS_API SoundBackend
+{
+public:
+	virtual ~SoundBackend() = default;
+
+	// How many frames Write accepts right now without blocking
+	virtual size_t GetWritableFrames() = 0;
+	virtual void Write(const float* frames, size_t framesCount) = 0;
+};
\ No newline at end of file
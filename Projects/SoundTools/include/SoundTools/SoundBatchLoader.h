@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "Common.h"
+#include "SoundBuffer.h"
+
+// Loads many wave files at once. Files are read and converted to the formats of the context
+// on a work-stealing pool with a thread per core, the thread that owns the context only
+// creates the OpenAL buffers from ready samples, a batch per Upload call.
+class SOUND_TOOLS_API SoundBatchLoader
+{
+public:
+	// Create it on the thread with the current context, its formats are captured here.
+	// Zero threadsCount makes one thread per core.
+	SoundBatchLoader(size_t threadsCount = 0);
+	SoundBatchLoader(const SoundBatchLoader&) = delete;
+	// Waits for the files being read, the queued ones are dropped
+	~SoundBatchLoader();
+
+	// Queues the files and returns the index of the first one, the others follow it
+	size_t Load(const char* const* filenames, size_t count);
+
+	// Creates buffers for up to maxCount files read so far and returns how many were handled,
+	// failed files included. onUploaded gets the index of each file. Context thread only.
+	size_t Upload(size_t maxCount = 64, const std::function<void(size_t index)>& onUploaded = nullptr);
+	// Uploads until every queued file is handled, waiting for the pool when it has to
+	void UploadAll(const std::function<void(size_t index)>& onUploaded = nullptr);
+
+	// All queued files are uploaded or failed
+	bool IsDone() const;
+	size_t GetFilesCount() const;
+	const char* GetFilename(size_t index) const;
+	// Null until the file is uploaded and for failed files
+	std::shared_ptr<SoundBuffer> GetBuffer(size_t index) const;
+	// Null unless the file failed
+	const char* GetError(size_t index) const;
+
+	SoundBatchLoader& operator=(const SoundBatchLoader&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
@@ -5,23 +5,35 @@
 #include <memory>
 
 #include "Common.h"
+#include "SampleEncoding.h"
+
+struct AlBufferData;
 
 class SOUND_TOOLS_API SoundBuffer
 {
 public:
 	SoundBuffer(
 		size_t channelsCount, size_t bitsPerSample, size_t sampleRate,
-		const void* data, size_t dataSize);
+		const void* data, size_t dataSize,
+		SampleEncoding encoding = SampleEncoding::Pcm,
+		size_t blockAlign = 0);
 	SoundBuffer(SoundBuffer&&);
 	SoundBuffer(const SoundBuffer&) = delete;
 	~SoundBuffer();
 
 	size_t GetId() const;
+	// Length in seconds at pitch 1
+	double GetDuration() const;
 
 	SoundBuffer& operator=(SoundBuffer&&);
 	SoundBuffer& operator=(const SoundBuffer&) = delete;
 
 private:
+	friend class SoundBatchLoader;
+
+	// Samples already converted to an OpenAL format, uploaded without any format queries
+	SoundBuffer(const AlBufferData& prepared, size_t sampleRate, double duration);
+
 	class Impl;
 	std::unique_ptr<Impl> m_d;
 };
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+
+#include "Common.h"
+#include "SoundBuffer.h"
+
+struct SoundBufferCacheStats
+{
+	size_t hits;
+	size_t misses;
+	// Misses served by a buffer loaded from another file with the same samples
+	size_t contentHits;
+	size_t buffersCount;
+};
+
+// Shares one SoundBuffer between all users of the same wave file
+class SOUND_TOOLS_API SoundBufferCache
+{
+public:
+	SoundBufferCache(bool deduplicateContent = false);
+	SoundBufferCache(const SoundBufferCache&) = delete;
+	~SoundBufferCache();
+
+	std::shared_ptr<SoundBuffer> Get(const char* filename);
+	// Like Get without loading, null when the file isn't cached
+	std::shared_ptr<SoundBuffer> Find(const char* filename);
+	// Adds a buffer loaded elsewhere, a file already in the cache keeps its buffer.
+	// Inserted buffers are not deduplicated by content.
+	void Insert(const char* filename, std::shared_ptr<SoundBuffer> buffer);
+
+	// Releases buffers that are referenced by the cache only
+	void Trim();
+	void Clear();
+
+	SoundBufferCacheStats GetStats() const;
+
+	SoundBufferCache& operator=(const SoundBufferCache&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "Common.h"
+#include "SoundRenderFormat.h"
+#include "WaveBuffer.h"
+
+class WaveWriter;
+
+// Records from an input device. A capture thread drains the device every few milliseconds
+// into a lock-free ring, so no samples are lost while the consumer stalls for less than
+// the ring duration. Reads take no locks and don't allocate, they belong to one consumer thread.
+class SOUND_TOOLS_API SoundCaptureDevice
+{
+public:
+	// Formats are mono or stereo 8 or 16-bit PCM, 32-bit float where the device supports it
+	SoundCaptureDevice(const SoundRenderFormat& format, const char* name = nullptr, double ringDuration = 2);
+	SoundCaptureDevice(const SoundCaptureDevice&) = delete;
+	~SoundCaptureDevice();
+
+	void* GetHandle() const;
+	const SoundRenderFormat& GetFormat() const;
+
+	void Start();
+	// Samples captured before the stop stay readable
+	void Stop();
+	bool IsCapturing() const;
+
+	size_t GetAvailableFrames() const;
+	// Frames the device captured while the ring was full
+	uint64_t GetDroppedFrames() const;
+
+	// Returns the number of frames read, up to framesCount
+	size_t Read(void* buffer, size_t framesCount);
+	// Writes all available frames, the writer has to be in the capture format
+	size_t Read(WaveWriter& writer);
+	WaveBuffer Read();
+
+	SoundCaptureDevice& operator=(const SoundCaptureDevice&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
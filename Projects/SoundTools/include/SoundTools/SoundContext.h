@@ -1,15 +1,38 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 #include "Common.h"
 
 class SoundDevice;
 
+// Requested context attributes, zero leaves the value to the device.
+// Loopback contexts always render at the sample rate of their device.
+struct SoundContextConfig
+{
+	size_t frequency = 0;
+	// Mixing updates per second, higher rates cut latency at some CPU cost
+	size_t refreshRate = 0;
+	size_t monoSourcesCount = 0;
+	size_t stereoSourcesCount = 0;
+	bool sync = false;
+};
+
+// Values the device settled on, which may differ from the requested ones
+struct SoundContextCapabilities
+{
+	size_t frequency;
+	size_t refreshRate;
+	size_t monoSourcesCount;
+	size_t stereoSourcesCount;
+	bool sync;
+};
+
 class SOUND_TOOLS_API SoundContext
 {
 public:
-	SoundContext(SoundDevice* device);
+	SoundContext(SoundDevice* device, const SoundContextConfig& config = SoundContextConfig());
 	SoundContext(const SoundContext&) = delete;
 	SoundContext(SoundContext&& that);
 	~SoundContext();
@@ -17,6 +40,13 @@ public:
 	void* GetHandle() const;
 	void SetCurrent() const;
 
+	// Reports zeros for values the implementation doesn't expose
+	SoundContextCapabilities GetCapabilities() const;
+
+	// Throws for OpenAL errors that batched calls left pending since the last check.
+	// Release builds check once per batch, call it once per frame or update.
+	void CheckErrors() const;
+
 	SoundContext& operator=(SoundContext&&);
 	SoundContext& operator=(const SoundContext&) = delete;
 
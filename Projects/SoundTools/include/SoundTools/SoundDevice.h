@@ -3,6 +3,8 @@
 #include <memory>
 
 #include "Common.h"
+#include "SoundRenderFormat.h"
+#include "WaveBuffer.h"
 
 class SOUND_TOOLS_API SoundDevice
 {
@@ -10,10 +12,19 @@ public:
 	SoundDevice(SoundDevice&& that);
 	SoundDevice(const SoundDevice&) = delete;
 	SoundDevice(const char* name = nullptr);
+	// Opens a loopback device that mixes on demand instead of playing
+	SoundDevice(const SoundRenderFormat& renderFormat);
 	~SoundDevice();
 
 	void* GetHandle() const;
 
+	bool IsLoopback() const;
+	const SoundRenderFormat& GetRenderFormat() const;
+
+	// Mixes the next frames of a loopback device, as fast as the CPU allows
+	void Render(void* buffer, size_t framesCount) const;
+	WaveBuffer Render(size_t framesCount) const;
+
 	SoundDevice& operator=(SoundDevice&& that);
 	SoundDevice& operator=(const SoundDevice&) = delete;
 
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Common.h"
+#include "SoundRenderFormat.h"
+
+// Produces samples block by block for a StreamingSoundSource.
+// Called from the source's refill thread only.
+class SOUND_TOOLS_API SoundGenerator
+{
+public:
+	virtual ~SoundGenerator() = default;
+
+	virtual SoundRenderFormat GetFormat() const = 0;
+	// Starts over from the beginning, for replays and looping
+	virtual void Rewind() = 0;
+	// Writes up to size bytes of whole frames and returns how many were written,
+	// zero once the sound has ended
+	virtual size_t Generate(void* data, size_t size) = 0;
+};
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "Common.h"
+
+class SoundBuffer;
+class SoundSource;
+
+using SoundCompletionCallback = std::function<void(uint64_t id)>;
+
+// Owns playing sources until they finish and reports completions.
+// Finished sources are found in one pass over the active set, polling only
+// the sources whose estimated end time (buffer length / pitch) has passed.
+class SOUND_TOOLS_API SoundLifecycleManager
+{
+public:
+	// With a zero tick no thread is started and completions are detected by Update
+	SoundLifecycleManager(std::chrono::milliseconds tick = std::chrono::milliseconds(20));
+	SoundLifecycleManager(const SoundLifecycleManager&) = delete;
+	~SoundLifecycleManager();
+
+	// Starts the source and keeps it with its buffer until playback ends.
+	// The callback is called from the thread that detects the completion.
+	uint64_t Play(
+		SoundSource&& source,
+		std::shared_ptr<SoundBuffer> buffer,
+		SoundCompletionCallback onComplete = nullptr);
+
+	// Runs fn on a tracked source under the manager lock, so fn must not call back
+	// into the manager. Returns false when the id has finished.
+	bool Access(uint64_t id, const std::function<void(SoundSource&)>& fn);
+	void Stop(uint64_t id);
+
+	// Returns the number of sources that finished
+	size_t Update();
+	size_t GetActiveCount() const;
+
+	SoundLifecycleManager& operator=(const SoundLifecycleManager&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "Common.h"
+#include "SoundBackend.h"
+#include "SoundMixerClip.h"
+
+struct SoundMixerVoice
+{
+	uint32_t index;
+	// Bumped when the voice finishes or is stopped, so old handles go stale
+	uint32_t generation;
+};
+
+struct SoundMixerStats
+{
+	size_t activeVoices;
+	uint64_t mixedFrames;
+	// Wall time spent in Mix, in total and in the last call
+	double mixSeconds;
+	double lastMixSeconds;
+};
+
+// Mixes voices into an interleaved float bus on the CPU, without a driver.
+// Pitch and sample rate differences are resampled with linear interpolation.
+// Not thread safe, one thread plays voices and renders.
+class SOUND_TOOLS_API SoundMixer
+{
+public:
+	SoundMixer(size_t channelsCount, size_t sampleRate, size_t voicesCapacity = 256);
+	SoundMixer(const SoundMixer&) = delete;
+	~SoundMixer();
+
+	SoundMixerVoice Play(
+		std::shared_ptr<const SoundMixerClip> clip,
+		float gain = 1,
+		float pitch = 1,
+		bool looping = false);
+
+	// These return false for voices that have finished
+	bool Stop(SoundMixerVoice voice);
+	bool IsPlaying(SoundMixerVoice voice) const;
+	bool SetGain(SoundMixerVoice voice, float gain);
+	bool SetPitch(SoundMixerVoice voice, float pitch);
+	bool SetLooping(SoundMixerVoice voice, bool looping);
+
+	// Writes the next framesCount frames of the mix to out
+	void Mix(float* out, size_t framesCount);
+	// Mixes as many of framesCount frames as the backend accepts, returns the frames written
+	size_t Render(SoundBackend& backend, size_t framesCount);
+
+	size_t GetChannelsCount() const;
+	size_t GetSampleRate() const;
+	SoundMixerStats GetStats() const;
+
+	SoundMixer& operator=(const SoundMixer&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
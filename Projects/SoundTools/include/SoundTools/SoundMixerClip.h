@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+
+#include "Common.h"
+
+class WaveBuffer;
+
+// Wave samples converted to float once, shared by every mixer voice that plays them
+class SOUND_TOOLS_API SoundMixerClip
+{
+public:
+	SoundMixerClip(const WaveBuffer& wave);
+	SoundMixerClip(const SoundMixerClip&) = delete;
+	~SoundMixerClip();
+
+	size_t GetChannelsCount() const;
+	size_t GetSampleRate() const;
+	size_t GetFramesCount() const;
+	// Interleaved, GetChannelsCount() samples per frame
+	const float* GetSamples() const;
+
+	SoundMixerClip& operator=(const SoundMixerClip&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+
+#include "Common.h"
+#include "WaveBuffer.h"
+
+// Many sounds in one file with their formats, a sorted name index and aligned payloads.
+// Opening maps the file once, sounds are then found by binary search and their wave
+// buffers view the mapping, so nothing is parsed or copied.
+class SOUND_TOOLS_API SoundPack
+{
+public:
+	SoundPack(const char* filename);
+	SoundPack(const SoundPack&) = delete;
+	~SoundPack();
+
+	size_t GetSoundsCount() const;
+	// Sounds are in index order, not in the order they were added
+	const char* GetName(size_t index) const;
+	bool Contains(const char* name) const;
+
+	// Throw std::out_of_range for unknown sounds. The buffers keep the mapping alive.
+	WaveBuffer GetWave(const char* name) const;
+	WaveBuffer GetWave(size_t index) const;
+
+	SoundPack& operator=(const SoundPack&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <memory>
+
+#include "Common.h"
+#include "WaveBuffer.h"
+
+// Collects wave buffers and writes them into a sound pack
+class SOUND_TOOLS_API SoundPackBuilder
+{
+public:
+	SoundPackBuilder();
+	SoundPackBuilder(const SoundPackBuilder&) = delete;
+	~SoundPackBuilder();
+
+	// Names have to be unique
+	void Add(const char* name, WaveBuffer&& wave);
+	size_t GetSoundsCount() const;
+	void Save(const char* filename) const;
+
+	SoundPackBuilder& operator=(const SoundPackBuilder&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
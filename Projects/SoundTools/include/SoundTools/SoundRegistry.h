@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "Common.h"
+#include "SampleEncoding.h"
+#include "SoundSource.h"
+#include "SoundSourceBatch.h"
+
+class WaveBuffer;
+
+// Generational handles into SoundRegistry storage. A handle goes stale once its
+// object is destroyed, the registry then ignores it instead of throwing.
+struct SoundSourceHandle
+{
+	uint32_t index;
+	uint32_t generation;
+};
+
+struct SoundBufferHandle
+{
+	uint32_t index;
+	uint32_t generation;
+};
+
+constexpr uint32_t invalidSoundHandleIndex = 0xFFFFFFFF;
+
+// Lightweight alternative to SoundSource and SoundBuffer objects: OpenAL names are
+// kept in contiguous slot maps, so creating and destroying sources allocates nothing.
+// Destroyed sources are reset and kept for the next CreateSource.
+// Not thread safe, use it from the thread that owns the context.
+class SOUND_TOOLS_API SoundRegistry
+{
+public:
+	SoundRegistry(size_t sourcesCapacity = 256, size_t buffersCapacity = 64);
+	SoundRegistry(const SoundRegistry&) = delete;
+	~SoundRegistry();
+
+	// Throws like SoundBuffer when the samples can't be uploaded
+	SoundBufferHandle CreateBuffer(
+		size_t channelsCount, size_t bitsPerSample, size_t sampleRate,
+		const void* data, size_t dataSize,
+		SampleEncoding encoding = SampleEncoding::Pcm,
+		size_t blockAlign = 0);
+	SoundBufferHandle CreateBuffer(const WaveBuffer& wave);
+	// Sources playing the buffer have to be detached first
+	bool DestroyBuffer(SoundBufferHandle buffer);
+	bool IsValid(SoundBufferHandle buffer) const;
+	// Zero for stale handles
+	double GetDuration(SoundBufferHandle buffer) const;
+
+	// Returns an invalid handle when OpenAL has no more sources
+	SoundSourceHandle CreateSource();
+	bool DestroySource(SoundSourceHandle source);
+	bool IsValid(SoundSourceHandle source) const;
+
+	// These do nothing and return false for stale handles.
+	// An invalid buffer handle detaches the current buffer.
+	bool SetBuffer(SoundSourceHandle source, SoundBufferHandle buffer);
+	bool Play(SoundSourceHandle source);
+	bool Pause(SoundSourceHandle source);
+	bool Stop(SoundSourceHandle source);
+	bool SetLooping(SoundSourceHandle source, bool looping);
+	bool SetPosition(SoundSourceHandle source, float x, float y, float z);
+	bool SetVelocity(SoundSourceHandle source, float x, float y, float z);
+	bool SetGain(SoundSourceHandle source, float gain);
+	bool SetPitch(SoundSourceHandle source, float pitch);
+	// Stale sources report Stopped
+	SoundSourceState GetState(SoundSourceHandle source) const;
+
+	// Applies the batch to sources[0..count) as one deferred update, skipping stale handles
+	void ApplyBatch(const SoundSourceHandle* sources, const SoundSourceBatch& batch);
+
+	size_t GetSourcesCount() const;
+	size_t GetBuffersCount() const;
+
+	SoundRegistry& operator=(const SoundRegistry&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
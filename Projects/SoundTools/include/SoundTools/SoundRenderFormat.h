@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+#include "SampleEncoding.h"
+
+// Sample format of loopback devices and generators, in the same terms as a WaveBuffer
+struct SoundRenderFormat
+{
+	size_t channelsCount;
+	size_t bitsPerSample;
+	size_t sampleRate;
+	SampleEncoding encoding;
+};
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include "Common.h"
+#include "SoundContext.h"
+#include "SoundGenerator.h"
+#include "SoundLifecycleManager.h"
+#include "SoundSource.h"
+
+class WaveBuffer;
+
+using SoundServerErrorHandler = std::function<void(uint64_t id, const char* message)>;
+
+// Owns the device and context on a dedicated thread that makes every OpenAL call.
+// Any thread may post commands: they go through a lock-free queue and are applied
+// in posting order, so handles can be used as soon as Play returns.
+class SOUND_TOOLS_API SoundServer
+{
+public:
+	// Throws when the device or the context can't be created.
+	// Errors of posted commands are reported from the server thread.
+	SoundServer(
+		const char* deviceName = nullptr,
+		SoundServerErrorHandler onError = nullptr,
+		std::chrono::milliseconds tick = std::chrono::milliseconds(10),
+		const SoundContextConfig& contextConfig = SoundContextConfig());
+	SoundServer(const SoundServer&) = delete;
+	~SoundServer();
+
+	// Completion callbacks are called from the server thread.
+	// Files not in the cache are read asynchronously, commands for the sound wait until it starts.
+	uint64_t Play(
+		const char* filename,
+		bool looping = false,
+		SoundCompletionCallback onComplete = nullptr);
+	uint64_t Play(
+		std::shared_ptr<const WaveBuffer> wave,
+		bool looping = false,
+		SoundCompletionCallback onComplete = nullptr);
+	// Streams the generator in small blocks, so memory doesn't grow with the duration
+	uint64_t Play(
+		std::unique_ptr<SoundGenerator> generator,
+		bool looping = false,
+		SoundCompletionCallback onComplete = nullptr);
+
+	// Reads and converts the files on a pool of threads, then puts their buffers into the
+	// cache Play by file name uses, a batch per tick. The result is the number of files loaded,
+	// failed ones are reported to the error handler.
+	std::future<size_t> Preload(const char* const* filenames, size_t count);
+
+	void Pause(uint64_t id);
+	void Resume(uint64_t id);
+	void Stop(uint64_t id);
+	void SetLooping(uint64_t id, bool looping);
+	void SetGain(uint64_t id, float gain);
+	void SetPitch(uint64_t id, float pitch);
+
+	// Finished sounds report Stopped
+	std::future<SoundSourceState> GetState(uint64_t id);
+
+	// Runs fn with the source on the server thread.
+	// The result is false when the sound has already finished or is streamed.
+	std::future<bool> Access(uint64_t id, std::function<void(SoundSource&)> fn);
+
+	// Runs fn on the server thread, where OpenAL calls are allowed
+	void Post(std::function<void()> fn);
+
+	SoundServer& operator=(const SoundServer&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <memory>
 
 #include "Common.h"
+#include "SoundSourceBatch.h"
 
 enum class SoundSourceState
 {
@@ -22,6 +23,9 @@ public:
 	SoundSource(const SoundSource&) = delete;
 	~SoundSource();
 
+	size_t GetId() const;
+
+	// Passing nullptr detaches the current buffer
 	void SetBuffer(SoundBuffer* buffer);
 	void Pause() const;
 	void Play() const;
@@ -31,6 +35,17 @@ public:
 	void SetLooping(bool looping);
 	bool GetLooping() const;
 
+	void SetPosition(float x, float y, float z);
+	void SetVelocity(float x, float y, float z);
+	void SetGain(float gain);
+	float GetGain() const;
+	void SetPitch(float pitch);
+	float GetPitch() const;
+
+	// Applies the batch to sources[0..count) as one deferred update of the current
+	// context, with a single error check for the whole batch. Null sources are skipped.
+	static void ApplyBatch(SoundSource* const* sources, const SoundSourceBatch& batch);
+
 	SoundSource& operator=(SoundSource&&);
 	SoundSource& operator=(const SoundSource&) = delete;
 
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+// Structure-of-arrays parameters for a batch of sources, element i belongs to source i.
+// A null array leaves that parameter unchanged, positions and velocities need all three axes.
+struct SoundSourceBatch
+{
+	size_t count;
+
+	const float* positionX;
+	const float* positionY;
+	const float* positionZ;
+
+	const float* velocityX;
+	const float* velocityY;
+	const float* velocityZ;
+
+	const float* gain;
+	const float* pitch;
+};
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "Common.h"
+
+class SoundContext;
+class SoundSource;
+
+struct SoundVoice
+{
+	uint32_t index;
+	// Bumped every time the voice is released or stolen, so old handles go stale
+	uint32_t generation;
+};
+
+// Preallocated sources handed out by priority, so running out of
+// sources costs the least important sound instead of an exception
+class SOUND_TOOLS_API SoundSourcePool
+{
+public:
+	// Sized from the mono and stereo source limits of the context's device
+	SoundSourcePool(const SoundContext& context);
+	SoundSourcePool(size_t sourcesCount);
+	SoundSourcePool(const SoundSourcePool&) = delete;
+	~SoundSourcePool();
+
+	// Takes a free or finished voice, otherwise steals the lowest priority
+	// (then quietest) voice whose priority does not exceed the requested one.
+	// Returns an invalid voice when every voice is more important.
+	// Released voices are reused without OpenAL calls. Once they run out,
+	// every voice that played to the end is freed in one pass.
+	SoundVoice Acquire(int priority);
+	void Release(SoundVoice voice);
+
+	bool IsValid(SoundVoice voice) const;
+	// Returns nullptr when the voice has been released or stolen
+	SoundSource* GetSource(SoundVoice voice) const;
+
+	size_t GetCapacity() const;
+	size_t GetActiveCount() const;
+
+	SoundSourcePool& operator=(const SoundSourcePool&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+
+#include "Common.h"
+#include "SoundGenerator.h"
+#include "SoundSource.h"
+
+// Plays a wave file or a generator by producing fixed-size blocks
+// into a small ring of queued OpenAL buffers from a background thread or from Update
+class SOUND_TOOLS_API StreamingSoundSource
+{
+public:
+	// Without a refill thread the owner keeps the stream going by calling Update
+	// more often than a block plays, from the thread that makes its other AL calls
+	StreamingSoundSource(
+		const char* filename,
+		size_t blockSize = 64 * 1024,
+		size_t buffersCount = 4,
+		bool refillThread = true);
+	// Memory use is bounded by the blocks, however long the generator runs
+	StreamingSoundSource(
+		std::unique_ptr<SoundGenerator> generator,
+		size_t blockSize = 64 * 1024,
+		size_t buffersCount = 4,
+		bool refillThread = true);
+	StreamingSoundSource(StreamingSoundSource&&);
+	StreamingSoundSource(const StreamingSoundSource&) = delete;
+	~StreamingSoundSource();
+
+	void Pause() const;
+	void Play() const;
+	void Stop() const;
+	SoundSourceState GetState() const;
+	// Refills the processed buffers. A stream that fails to refill is stopped and the error rethrown
+	void Update();
+
+	void SetLooping(bool looping);
+	bool GetLooping() const;
+	void SetGain(float gain);
+	void SetPitch(float pitch);
+
+	StreamingSoundSource& operator=(StreamingSoundSource&&);
+	StreamingSoundSource& operator=(const StreamingSoundSource&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
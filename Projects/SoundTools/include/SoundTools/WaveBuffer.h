@@ -3,31 +3,83 @@
 #include <memory>
 
 #include "Common.h"
+#include "SampleEncoding.h"
+#include "WaveContainer.h"
 #include "SoundBuffer.h"
+#include "WaveChunkIndex.h"
+
+class MappedFile;
+
+enum class WaveBufferStorage
+{
+	// Payload is read into a heap buffer owned by the wave buffer
+	Copy,
+	// Payload is a read-only view of the memory-mapped file
+	Mapped
+};
 
 class SOUND_TOOLS_API WaveBuffer
 {
 public:
-	WaveBuffer(const char* filename);
+	WaveBuffer(const char* filename, WaveBufferStorage storage = WaveBufferStorage::Copy);
+	// Parses a whole wave file already read into memory, the samples are used in place
+	WaveBuffer(std::unique_ptr<uint8_t[]>&& file, size_t fileSize);
+	// blockAlign is the ADPCM block size in bytes, zero for the default one
 	WaveBuffer(
 		size_t channelsCount, size_t bitsPerSample, size_t sampleRate,
-		void* data, size_t dataSize);
+		void* data, size_t dataSize,
+		SampleEncoding encoding = SampleEncoding::Pcm,
+		size_t blockAlign = 0);
 	WaveBuffer(
 		size_t channelsCount, size_t bitsPerSample, size_t sampleRate,
-		std::unique_ptr<uint8_t[]>&& data, size_t dataSize);
+		std::unique_ptr<uint8_t[]>&& data, size_t dataSize,
+		SampleEncoding encoding = SampleEncoding::Pcm,
+		size_t blockAlign = 0);
 	WaveBuffer(WaveBuffer&&);
 	WaveBuffer(const WaveBuffer&) = delete;
+	~WaveBuffer();
+
+	size_t GetChannelsCount() const;
+	size_t GetBitsPerSample() const;
+	size_t GetSampleRate() const;
+	SampleEncoding GetEncoding() const;
+	// Bytes per frame, or per block for ADPCM
+	size_t GetBlockAlign() const;
+	size_t GetFramesCount() const;
+	const void* GetData() const;
+	size_t GetDataSize() const;
+	bool IsMapped() const;
+	const WaveChunkIndex& GetChunkIndex() const;
 
 	SoundBuffer MakeSoundBuffer() const;
-	void SaveToFile(const char* filename) const;
+	// RIFF files become RF64 when the samples don't fit 4 GB
+	void SaveToFile(const char* filename, WaveContainer container = WaveContainer::Riff) const;
+
+	// Converts the samples to 16-bit PCM, mu-law or ADPCM. ADPCM needs a quarter of the
+	// memory of 16-bit PCM and stays compressed in OpenAL buffers where the context supports it.
+	// A zero blockAlign picks the block size OpenAL takes without AL_SOFT_block_alignment.
+	WaveBuffer Encode(SampleEncoding encoding, size_t blockAlign = 0) const;
 
 	WaveBuffer& operator=(WaveBuffer&&);
 	WaveBuffer& operator=(const WaveBuffer&) = delete;
 
 private:
+	friend class SoundPack;
+
+	// View of samples inside a mapped file
+	WaveBuffer(
+		std::shared_ptr<const MappedFile> mapping, const uint8_t* view, size_t dataSize,
+		size_t channelsCount, size_t bitsPerSample, size_t sampleRate,
+		SampleEncoding encoding, size_t blockAlign);
+
 	size_t m_channelsCount;
 	size_t m_bitsPerSample;
 	size_t m_sampleRate;
 	size_t m_dataSize;
+	size_t m_blockAlign;
+	SampleEncoding m_encoding;
 	std::unique_ptr<uint8_t[]> m_data;
+	std::shared_ptr<const MappedFile> m_mapping;
+	const uint8_t* m_view;
+	WaveChunkIndex m_chunks;
 };
\ No newline at end of file
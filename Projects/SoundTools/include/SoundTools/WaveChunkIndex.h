@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Common.h"
+
+struct WaveChunk
+{
+	char id[4];
+	// Offset of the chunk payload from the beginning of the file
+	uint64_t offset;
+	// Size of the chunk payload without the header and pad byte
+	uint64_t size;
+};
+
+// Locations of all top-level chunks of a RIFF WAVE file, in file order
+class SOUND_TOOLS_API WaveChunkIndex
+{
+public:
+	WaveChunkIndex();
+	WaveChunkIndex(std::vector<WaveChunk>&& chunks);
+
+	const WaveChunk* Find(const char* id) const;
+	const std::vector<WaveChunk>& GetChunks() const;
+
+private:
+	std::vector<WaveChunk> m_chunks;
+};
\ No newline at end of file
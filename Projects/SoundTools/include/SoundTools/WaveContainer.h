@@ -0,0 +1,11 @@
+#pragma once
+
+enum class WaveContainer
+{
+	// RIFF WAVE, sizes are 32-bit so files stay below 4 GB
+	Riff,
+	// RIFF layout with the 64-bit sizes in a ds64 chunk, BW64 files read as this too
+	Rf64,
+	// Sony Wave64, chunks named by GUIDs with 64-bit sizes
+	Wave64
+};
\ No newline at end of file
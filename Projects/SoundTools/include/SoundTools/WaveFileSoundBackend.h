@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+
+#include "SoundBackend.h"
+
+// Streams the mix into a wave file of 32-bit float samples as it is rendered,
+// for renders too long to collect in memory with WaveSoundBackend
+class SOUND_TOOLS_API WaveFileSoundBackend : public SoundBackend
+{
+public:
+	// Zero flushInterval patches the file header on Close only
+	WaveFileSoundBackend(const char* filename, size_t channelsCount, size_t sampleRate, double flushInterval = 1);
+	WaveFileSoundBackend(const WaveFileSoundBackend&) = delete;
+	~WaveFileSoundBackend();
+
+	size_t GetWritableFrames() override;
+	void Write(const float* frames, size_t framesCount) override;
+
+	size_t GetWrittenFrames() const;
+	// Nothing can be written afterwards
+	void Close();
+
+	WaveFileSoundBackend& operator=(const WaveFileSoundBackend&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Common.h"
+#include "SampleEncoding.h"
+#include "WaveContainer.h"
+#include "WaveChunkIndex.h"
+
+// Format and layout of a wave file, read from its chunk headers only
+class SOUND_TOOLS_API WaveInfo
+{
+public:
+	WaveInfo(const char* filename);
+
+	size_t GetChannelsCount() const;
+	size_t GetBitsPerSample() const;
+	size_t GetSampleRate() const;
+	SampleEncoding GetEncoding() const;
+	// Bytes per frame, or per block for ADPCM
+	size_t GetBlockAlign() const;
+	WaveContainer GetContainer() const;
+
+	uint64_t GetDataOffset() const;
+	uint64_t GetDataSize() const;
+	uint64_t GetFramesCount() const;
+	double GetDuration() const;
+
+	const WaveChunkIndex& GetChunkIndex() const;
+
+private:
+	size_t m_channelsCount;
+	size_t m_bitsPerSample;
+	size_t m_sampleRate;
+	SampleEncoding m_encoding;
+	size_t m_blockAlign;
+	WaveContainer m_container;
+	uint64_t m_dataOffset;
+	uint64_t m_dataSize;
+	WaveChunkIndex m_chunks;
+};
\ No newline at end of file
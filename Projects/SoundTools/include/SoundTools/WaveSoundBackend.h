@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+
+#include "SoundBackend.h"
+#include "WaveBuffer.h"
+
+// Collects the mix in memory as 32-bit float samples
+class SOUND_TOOLS_API WaveSoundBackend : public SoundBackend
+{
+public:
+	WaveSoundBackend(size_t channelsCount, size_t sampleRate);
+	WaveSoundBackend(const WaveSoundBackend&) = delete;
+	~WaveSoundBackend();
+
+	size_t GetWritableFrames() override;
+	void Write(const float* frames, size_t framesCount) override;
+
+	size_t GetWrittenFrames() const;
+	// Copies what was written so far, the backend keeps collecting
+	WaveBuffer MakeWaveBuffer() const;
+	void SaveToFile(const char* filename) const;
+
+	WaveSoundBackend& operator=(const WaveSoundBackend&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
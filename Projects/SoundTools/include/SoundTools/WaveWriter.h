@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "Common.h"
+#include "SampleEncoding.h"
+#include "WaveContainer.h"
+
+// Writes a wave file as its samples are produced, so recordings of any length never have to
+// be held in memory. Samples go through one large buffer and reach the file in big writes.
+// The header sizes are patched whenever the writer flushes, so a file left by a crash is
+// valid up to the last flush. RIFF files keep a JUNK chunk where the ds64 chunk goes,
+// so they are turned into RF64 in place once they outgrow 4 GB.
+class SOUND_TOOLS_API WaveWriter
+{
+public:
+	// blockAlign is the ADPCM block size in bytes, zero for the default one
+	WaveWriter(
+		const char* filename,
+		size_t channelsCount, size_t bitsPerSample, size_t sampleRate,
+		SampleEncoding encoding = SampleEncoding::Pcm,
+		size_t blockAlign = 0,
+		WaveContainer container = WaveContainer::Riff,
+		size_t bufferSize = 1024 * 1024);
+	WaveWriter(const WaveWriter&) = delete;
+	// Closes the file, errors are ignored here
+	~WaveWriter();
+
+	// Samples in the file's format, frames may be split between calls.
+	// ADPCM files take whole blocks.
+	void Write(const void* data, size_t size);
+
+	// Writes the buffered samples and patches the header to cover them
+	void Flush();
+	// Flushes each time this much audio has been written, zero flushes on Close only
+	void SetFlushInterval(double seconds);
+	void Close();
+
+	uint64_t GetFramesCount() const;
+	uint64_t GetDataSize() const;
+
+	WaveWriter& operator=(const WaveWriter&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
@@ -0,0 +1,452 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "Adpcm.h"
+
+const int16_t msAdpcmCoefficients[msAdpcmCoefficientsCount][2] =
+{
+	{ 256, 0 },
+	{ 512, -256 },
+	{ 0, 0 },
+	{ 192, 64 },
+	{ 240, 0 },
+	{ 460, -208 },
+	{ 392, -232 }
+};
+
+namespace
+{
+	const int imaStepTable[89] =
+	{
+		7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+		19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+		50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+		130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+		337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+		876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+		2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+		5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+		15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+	};
+
+	const int imaIndexTable[16] =
+	{
+		-1, -1, -1, -1, 2, 4, 6, 8,
+		-1, -1, -1, -1, 2, 4, 6, 8
+	};
+
+	const int msAdaptationTable[16] =
+	{
+		230, 230, 230, 230, 307, 409, 512, 614,
+		768, 614, 512, 409, 307, 230, 230, 230
+	};
+
+	constexpr int msMinDelta = 16;
+
+	int16_t Clamp16(int value)
+	{
+		return static_cast<int16_t>(std::min<int>(std::max<int>(value, std::numeric_limits<int16_t>::min()), std::numeric_limits<int16_t>::max()));
+	}
+
+	int16_t Read16(const uint8_t* src)
+	{
+		int16_t value;
+		std::memcpy(&value, src, sizeof(value));
+		return value;
+	}
+
+	void Write16(uint8_t* dst, int value)
+	{
+		auto sample = static_cast<int16_t>(value);
+		std::memcpy(dst, &sample, sizeof(sample));
+	}
+
+	struct ImaState
+	{
+		int predictor;
+		int index;
+	};
+
+	int16_t DecodeImaNibble(ImaState& state, uint8_t nibble)
+	{
+		auto step = imaStepTable[state.index];
+		auto diff = step >> 3;
+
+		if (nibble & 4) diff += step;
+		if (nibble & 2) diff += step >> 1;
+		if (nibble & 1) diff += step >> 2;
+
+		state.predictor = Clamp16((nibble & 8) ? state.predictor - diff : state.predictor + diff);
+		state.index = std::min(std::max(state.index + imaIndexTable[nibble], 0), 88);
+
+		return static_cast<int16_t>(state.predictor);
+	}
+
+	uint8_t EncodeImaNibble(ImaState& state, int sample)
+	{
+		auto step = imaStepTable[state.index];
+		auto diff = sample - state.predictor;
+		uint8_t nibble = 0;
+
+		if (diff < 0)
+		{
+			nibble = 8;
+			diff = -diff;
+		}
+
+		if (diff >= step)
+		{
+			nibble |= 4;
+			diff -= step;
+		}
+
+		if (diff >= step >> 1)
+		{
+			nibble |= 2;
+			diff -= step >> 1;
+		}
+
+		if (diff >= step >> 2)
+		{
+			nibble |= 1;
+		}
+
+		// Decode the nibble back so the state follows the decoder exactly
+		DecodeImaNibble(state, nibble);
+		return nibble;
+	}
+
+	struct MsState
+	{
+		int coefficient1;
+		int coefficient2;
+		int delta;
+		int sample1;
+		int sample2;
+	};
+
+	int16_t DecodeMsNibble(MsState& state, uint8_t nibble)
+	{
+		auto predicted = (state.sample1 * state.coefficient1 + state.sample2 * state.coefficient2) / 256;
+		auto value = Clamp16(predicted + (nibble >= 8 ? nibble - 16 : nibble) * state.delta);
+
+		state.sample2 = state.sample1;
+		state.sample1 = value;
+		state.delta = std::max(msAdaptationTable[nibble] * state.delta / 256, msMinDelta);
+
+		return value;
+	}
+
+	uint8_t EncodeMsNibble(MsState& state, int sample)
+	{
+		auto predicted = (state.sample1 * state.coefficient1 + state.sample2 * state.coefficient2) / 256;
+		auto error = sample - predicted;
+		auto rounding = error >= 0 ? state.delta / 2 : -state.delta / 2;
+		auto value = std::min(std::max((error + rounding) / state.delta, -8), 7);
+		auto nibble = static_cast<uint8_t>(value & 0xF);
+
+		DecodeMsNibble(state, nibble);
+		return nibble;
+	}
+
+	void DecodeImaBlock(const uint8_t* block, size_t channels, size_t framesPerBlock, int16_t* dst)
+	{
+		ImaState states[16];
+
+		for (size_t channel = 0; channel < channels; ++channel)
+		{
+			auto header = block + channel * 4;
+			states[channel].predictor = Read16(header);
+			states[channel].index = std::min<int>(header[2], 88);
+			dst[channel] = static_cast<int16_t>(states[channel].predictor);
+		}
+
+		// Each channel continues in groups of eight samples packed into four bytes
+		auto data = block + channels * 4;
+		auto groupsCount = (framesPerBlock - 1) / 8;
+
+		for (size_t group = 0; group < groupsCount; ++group)
+		{
+			for (size_t channel = 0; channel < channels; ++channel)
+			{
+				auto bytes = data + (group * channels + channel) * 4;
+				auto frame = 1 + group * 8;
+
+				for (size_t i = 0; i < 8; ++i)
+				{
+					auto nibble = static_cast<uint8_t>((i & 1) ? bytes[i / 2] >> 4 : bytes[i / 2] & 0xF);
+					dst[(frame + i) * channels + channel] = DecodeImaNibble(states[channel], nibble);
+				}
+			}
+		}
+	}
+
+	void EncodeImaBlock(const int16_t* src, size_t channels, size_t framesPerBlock, ImaState* states, uint8_t* block)
+	{
+		for (size_t channel = 0; channel < channels; ++channel)
+		{
+			auto header = block + channel * 4;
+			states[channel].predictor = src[channel];
+			Write16(header, src[channel]);
+			header[2] = static_cast<uint8_t>(states[channel].index);
+			header[3] = 0;
+		}
+
+		auto data = block + channels * 4;
+		auto groupsCount = (framesPerBlock - 1) / 8;
+
+		for (size_t group = 0; group < groupsCount; ++group)
+		{
+			for (size_t channel = 0; channel < channels; ++channel)
+			{
+				auto bytes = data + (group * channels + channel) * 4;
+				auto frame = 1 + group * 8;
+
+				for (size_t i = 0; i < 8; i += 2)
+				{
+					auto low = EncodeImaNibble(states[channel], src[(frame + i) * channels + channel]);
+					auto high = EncodeImaNibble(states[channel], src[(frame + i + 1) * channels + channel]);
+					bytes[i / 2] = static_cast<uint8_t>(low | (high << 4));
+				}
+			}
+		}
+	}
+
+	void DecodeMsBlock(const uint8_t* block, size_t channels, size_t framesPerBlock, int16_t* dst)
+	{
+		MsState states[16];
+
+		for (size_t channel = 0; channel < channels; ++channel)
+		{
+			auto predictor = block[channel];
+
+			if (predictor >= msAdpcmCoefficientsCount)
+			{
+				throw std::invalid_argument("Invalid ADPCM data");
+			}
+
+			auto& state = states[channel];
+			state.coefficient1 = msAdpcmCoefficients[predictor][0];
+			state.coefficient2 = msAdpcmCoefficients[predictor][1];
+			state.delta = Read16(block + channels + channel * 2);
+			state.sample1 = Read16(block + channels * 3 + channel * 2);
+			state.sample2 = Read16(block + channels * 5 + channel * 2);
+
+			// The header holds the first two frames, older one last
+			dst[channel] = static_cast<int16_t>(state.sample2);
+			dst[channels + channel] = static_cast<int16_t>(state.sample1);
+		}
+
+		// Nibbles follow frame by frame, high nibble first
+		auto data = block + channels * 7;
+		auto nibblesCount = (framesPerBlock - 2) * channels;
+
+		for (size_t i = 0; i < nibblesCount; ++i)
+		{
+			auto nibble = static_cast<uint8_t>((i & 1) ? data[i / 2] & 0xF : data[i / 2] >> 4);
+			dst[channels * 2 + i] = DecodeMsNibble(states[i % channels], nibble);
+		}
+	}
+
+	MsState StartMsChannel(const int16_t* src, size_t channels, size_t channel, size_t predictor)
+	{
+		MsState state;
+		state.coefficient1 = msAdpcmCoefficients[predictor][0];
+		state.coefficient2 = msAdpcmCoefficients[predictor][1];
+		state.sample2 = src[channel];
+		state.sample1 = src[channels + channel];
+
+		// Sized so the first prediction error lands in the middle of the nibble range
+		auto predicted = (state.sample1 * state.coefficient1 + state.sample2 * state.coefficient2) / 256;
+		state.delta = std::max(std::abs(src[channels * 2 + channel] - predicted) / 4, msMinDelta);
+
+		return state;
+	}
+
+	// Picks the predictor with the smallest squared error over the block
+	size_t ChooseMsPredictor(const int16_t* src, size_t channels, size_t channel, size_t framesPerBlock)
+	{
+		size_t best = 0;
+		auto bestError = std::numeric_limits<double>::max();
+
+		for (size_t predictor = 0; predictor < msAdpcmCoefficientsCount; ++predictor)
+		{
+			auto state = StartMsChannel(src, channels, channel, predictor);
+			double error = 0;
+
+			for (size_t frame = 2; frame < framesPerBlock && error < bestError; ++frame)
+			{
+				int sample = src[frame * channels + channel];
+				EncodeMsNibble(state, sample);
+				error += static_cast<double>(sample - state.sample1) * (sample - state.sample1);
+			}
+
+			if (error < bestError)
+			{
+				best = predictor;
+				bestError = error;
+			}
+		}
+
+		return best;
+	}
+
+	void EncodeMsBlock(const int16_t* src, size_t channels, size_t framesPerBlock, uint8_t* block)
+	{
+		MsState states[16];
+
+		for (size_t channel = 0; channel < channels; ++channel)
+		{
+			auto predictor = ChooseMsPredictor(src, channels, channel, framesPerBlock);
+			auto& state = states[channel] = StartMsChannel(src, channels, channel, predictor);
+
+			block[channel] = static_cast<uint8_t>(predictor);
+			Write16(block + channels + channel * 2, state.delta);
+			Write16(block + channels * 3 + channel * 2, state.sample1);
+			Write16(block + channels * 5 + channel * 2, state.sample2);
+		}
+
+		auto data = block + channels * 7;
+		auto nibblesCount = (framesPerBlock - 2) * channels;
+
+		for (size_t i = 0; i < nibblesCount; ++i)
+		{
+			auto nibble = EncodeMsNibble(states[i % channels], src[channels * 2 + i]);
+
+			if (i & 1)
+			{
+				data[i / 2] |= nibble;
+			}
+			else
+			{
+				data[i / 2] = static_cast<uint8_t>(nibble << 4);
+			}
+		}
+	}
+
+	// Both codecs keep per-channel state on the stack
+	size_t CheckBlockLayout(SampleEncoding encoding, size_t channels, size_t blockAlign)
+	{
+		auto framesPerBlock = GetAdpcmFramesPerBlock(encoding, channels, blockAlign);
+
+		if (channels == 0 || channels > 16 || framesPerBlock == 0)
+		{
+			throw std::invalid_argument("Invalid ADPCM block layout");
+		}
+
+		return framesPerBlock;
+	}
+}
+
+bool IsAdpcm(SampleEncoding encoding)
+{
+	return encoding == SampleEncoding::ImaAdpcm || encoding == SampleEncoding::MsAdpcm;
+}
+
+size_t GetDefaultAdpcmBlockAlign(SampleEncoding encoding, size_t channels)
+{
+	return (encoding == SampleEncoding::ImaAdpcm ? 36 : 38) * channels;
+}
+
+size_t GetAdpcmFramesPerBlock(SampleEncoding encoding, size_t channels, size_t blockAlign)
+{
+	if (channels == 0)
+	{
+		return 0;
+	}
+
+	if (encoding == SampleEncoding::ImaAdpcm)
+	{
+		// One header sample, then groups of eight samples per channel
+		auto headerSize = channels * 4;
+
+		if (blockAlign <= headerSize || (blockAlign - headerSize) % headerSize != 0)
+		{
+			return 0;
+		}
+
+		return (blockAlign - headerSize) * 2 / channels + 1;
+	}
+
+	if (encoding == SampleEncoding::MsAdpcm)
+	{
+		// Two header samples, then one nibble per sample
+		auto headerSize = channels * 7;
+
+		if (blockAlign <= headerSize || (blockAlign - headerSize) * 2 % channels != 0)
+		{
+			return 0;
+		}
+
+		return (blockAlign - headerSize) * 2 / channels + 2;
+	}
+
+	return 0;
+}
+
+void DecodeAdpcm(
+	SampleEncoding encoding, size_t channels, size_t blockAlign,
+	const void* src, size_t srcSize,
+	std::vector<uint8_t>& dst)
+{
+	auto framesPerBlock = CheckBlockLayout(encoding, channels, blockAlign);
+	auto blocksCount = srcSize / blockAlign;
+	auto blockSamples = framesPerBlock * channels;
+	auto bytes = static_cast<const uint8_t*>(src);
+
+	dst.resize(blocksCount * blockSamples * sizeof(int16_t));
+	auto out = reinterpret_cast<int16_t*>(dst.data());
+
+	for (size_t block = 0; block < blocksCount; ++block)
+	{
+		if (encoding == SampleEncoding::ImaAdpcm)
+		{
+			DecodeImaBlock(bytes + block * blockAlign, channels, framesPerBlock, out + block * blockSamples);
+		}
+		else
+		{
+			DecodeMsBlock(bytes + block * blockAlign, channels, framesPerBlock, out + block * blockSamples);
+		}
+	}
+}
+
+void EncodeAdpcm(
+	SampleEncoding encoding, size_t channels, size_t blockAlign,
+	const int16_t* src, size_t framesCount,
+	std::vector<uint8_t>& dst)
+{
+	auto framesPerBlock = CheckBlockLayout(encoding, channels, blockAlign);
+	auto blocksCount = (framesCount + framesPerBlock - 1) / framesPerBlock;
+	auto blockSamples = framesPerBlock * channels;
+
+	dst.assign(blocksCount * blockAlign, 0);
+
+	// IMA step indices carry over from block to block
+	ImaState imaStates[16] = {};
+	std::vector<int16_t> padded(blockSamples);
+
+	for (size_t block = 0; block < blocksCount; ++block)
+	{
+		auto first = block * framesPerBlock;
+		auto samples = src + first * channels;
+
+		if (first + framesPerBlock > framesCount)
+		{
+			auto count = (framesCount - first) * channels;
+			std::fill(std::copy(samples, samples + count, padded.begin()), padded.end(), static_cast<int16_t>(0));
+			samples = padded.data();
+		}
+
+		if (encoding == SampleEncoding::ImaAdpcm)
+		{
+			EncodeImaBlock(samples, channels, framesPerBlock, imaStates, dst.data() + block * blockAlign);
+		}
+		else
+		{
+			EncodeMsBlock(samples, channels, framesPerBlock, dst.data() + block * blockAlign);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SoundTools/SampleEncoding.h"
+
+// IMA and Microsoft ADPCM blocks as laid out in wave files. blockAlign is the size
+// of a block in bytes, for all channels. Microsoft ADPCM uses the standard coefficients only.
+
+constexpr size_t msAdpcmCoefficientsCount = 7;
+extern const int16_t msAdpcmCoefficients[msAdpcmCoefficientsCount][2];
+
+bool IsAdpcm(SampleEncoding encoding);
+
+// Block size OpenAL accepts without AL_SOFT_block_alignment, 65 and 64 frames per block
+size_t GetDefaultAdpcmBlockAlign(SampleEncoding encoding, size_t channels);
+
+// Zero when the blocks can't hold the headers or split unevenly between channels
+size_t GetAdpcmFramesPerBlock(SampleEncoding encoding, size_t channels, size_t blockAlign);
+
+// Decodes whole blocks to interleaved 16-bit PCM, a trailing partial block is dropped
+void DecodeAdpcm(
+	SampleEncoding encoding, size_t channels, size_t blockAlign,
+	const void* src, size_t srcSize,
+	std::vector<uint8_t>& dst);
+
+// Encodes interleaved 16-bit PCM, the last block is padded with silence
+void EncodeAdpcm(
+	SampleEncoding encoding, size_t channels, size_t blockAlign,
+	const int16_t* src, size_t framesCount,
+	std::vector<uint8_t>& dst);
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <AL/alext.h>
+
+#include "Adpcm.h"
+#include "AlFormat.h"
+#include "OpenAlTools.h"
+#include "SampleConversion.h"
+
+namespace
+{
+	enum class AlSampleType
+	{
+		Pcm8,
+		Pcm16,
+		Float32,
+		Float64,
+		MuLaw,
+		ImaAdpcm,
+		MsAdpcm
+	};
+
+	// Returns AL_NONE when there is no such format for the channel layout
+	ALenum FindAlFormat(const AlFormatSupport& support, size_t channels, AlSampleType type)
+	{
+		if (channels == 1 || channels == 2)
+		{
+			bool stereo = (channels > 1);
+
+			switch (type)
+			{
+			case AlSampleType::Pcm8: return stereo ? AL_FORMAT_STEREO8 : AL_FORMAT_MONO8;
+			case AlSampleType::Pcm16: return stereo ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
+			case AlSampleType::Float32:
+				if (support.float32)
+				{
+					return stereo ? AL_FORMAT_STEREO_FLOAT32 : AL_FORMAT_MONO_FLOAT32;
+				}
+				break;
+			case AlSampleType::Float64:
+				if (support.float64)
+				{
+					return stereo ? AL_FORMAT_STEREO_DOUBLE_EXT : AL_FORMAT_MONO_DOUBLE_EXT;
+				}
+				break;
+			case AlSampleType::MuLaw:
+				if (support.muLaw)
+				{
+					return stereo ? AL_FORMAT_STEREO_MULAW_EXT : AL_FORMAT_MONO_MULAW_EXT;
+				}
+				break;
+			case AlSampleType::ImaAdpcm:
+				if (support.imaAdpcm)
+				{
+					return stereo ? AL_FORMAT_STEREO_IMA4 : AL_FORMAT_MONO_IMA4;
+				}
+				break;
+			case AlSampleType::MsAdpcm:
+				if (support.msAdpcm)
+				{
+					return stereo ? AL_FORMAT_STEREO_MSADPCM_SOFT : AL_FORMAT_MONO_MSADPCM_SOFT;
+				}
+				break;
+			}
+
+			return AL_NONE;
+		}
+
+		// There are no multichannel ADPCM formats
+		if (type == AlSampleType::MuLaw)
+		{
+			if (!support.muLawMultichannel)
+			{
+				return AL_NONE;
+			}
+
+			switch (channels)
+			{
+			case 4: return AL_FORMAT_QUAD_MULAW;
+			case 6: return AL_FORMAT_51CHN_MULAW;
+			case 7: return AL_FORMAT_61CHN_MULAW;
+			case 8: return AL_FORMAT_71CHN_MULAW;
+			}
+
+			return AL_NONE;
+		}
+
+		if (type == AlSampleType::Float64 || type == AlSampleType::ImaAdpcm || type == AlSampleType::MsAdpcm ||
+			!support.multichannel)
+		{
+			return AL_NONE;
+		}
+
+		// Multichannel 32-bit formats are float
+		auto pick = [type](ALenum pcm8, ALenum pcm16, ALenum float32)
+		{
+			switch (type)
+			{
+			case AlSampleType::Pcm8: return pcm8;
+			case AlSampleType::Pcm16: return pcm16;
+			default: return float32;
+			}
+		};
+
+		switch (channels)
+		{
+		case 4: return pick(AL_FORMAT_QUAD8, AL_FORMAT_QUAD16, AL_FORMAT_QUAD32);
+		case 6: return pick(AL_FORMAT_51CHN8, AL_FORMAT_51CHN16, AL_FORMAT_51CHN32);
+		case 7: return pick(AL_FORMAT_61CHN8, AL_FORMAT_61CHN16, AL_FORMAT_61CHN32);
+		case 8: return pick(AL_FORMAT_71CHN8, AL_FORMAT_71CHN16, AL_FORMAT_71CHN32);
+		}
+
+		return AL_NONE;
+	}
+}
+
+AlFormatSupport GetAlFormatSupport()
+{
+	AlFormatSupport support;
+	support.float32 = alIsExtensionPresent("AL_EXT_float32") != AL_FALSE;
+	support.float64 = alIsExtensionPresent("AL_EXT_double") != AL_FALSE;
+	support.muLaw = alIsExtensionPresent("AL_EXT_MULAW") != AL_FALSE;
+	support.muLawMultichannel = alIsExtensionPresent("AL_EXT_MULAW_MCFORMATS") != AL_FALSE;
+	support.imaAdpcm = alIsExtensionPresent("AL_EXT_IMA4") != AL_FALSE;
+	support.msAdpcm = alIsExtensionPresent("AL_SOFT_MSADPCM") != AL_FALSE;
+	support.blockAlignment = alIsExtensionPresent("AL_SOFT_block_alignment") != AL_FALSE;
+	support.multichannel = alIsExtensionPresent("AL_EXT_MCFORMATS") != AL_FALSE;
+	return support;
+}
+
+AlFormat ChooseAlFormat(size_t channels, size_t bitsPerSample, SampleEncoding encoding)
+{
+	return ChooseAlFormat(GetAlFormatSupport(), channels, bitsPerSample, encoding);
+}
+
+AlFormat ChooseAlFormat(const AlFormatSupport& support, size_t channels, size_t bitsPerSample, SampleEncoding encoding)
+{
+	auto direct = [&](AlSampleType type) -> AlFormat
+	{
+		return { FindAlFormat(support, channels, type), encoding, bitsPerSample };
+	};
+
+	auto toFloat32 = [&]() -> AlFormat
+	{
+		return { FindAlFormat(support, channels, AlSampleType::Float32), SampleEncoding::Float, 32 };
+	};
+
+	auto toPcm16 = [&]() -> AlFormat
+	{
+		return { FindAlFormat(support, channels, AlSampleType::Pcm16), SampleEncoding::Pcm, 16 };
+	};
+
+	AlFormat result = { AL_NONE, encoding, bitsPerSample };
+
+	if (encoding == SampleEncoding::Pcm)
+	{
+		switch (bitsPerSample)
+		{
+		case 8:
+			result = direct(AlSampleType::Pcm8);
+			break;
+		case 16:
+			result = direct(AlSampleType::Pcm16);
+			break;
+		case 24:
+		case 32:
+			result = toFloat32();
+			if (result.format == AL_NONE)
+			{
+				result = toPcm16();
+			}
+			break;
+		}
+	}
+	else if (encoding == SampleEncoding::Float)
+	{
+		switch (bitsPerSample)
+		{
+		case 32:
+			result = direct(AlSampleType::Float32);
+			if (result.format == AL_NONE)
+			{
+				result = toPcm16();
+			}
+			break;
+		case 64:
+			result = direct(AlSampleType::Float64);
+			if (result.format == AL_NONE)
+			{
+				result = toFloat32();
+			}
+			if (result.format == AL_NONE)
+			{
+				result = toPcm16();
+			}
+			break;
+		}
+	}
+	else if (encoding == SampleEncoding::MuLaw && bitsPerSample == 8)
+	{
+		result = direct(AlSampleType::MuLaw);
+		if (result.format == AL_NONE)
+		{
+			result = toPcm16();
+		}
+	}
+	else if (IsAdpcm(encoding) && bitsPerSample == 4)
+	{
+		result = direct(encoding == SampleEncoding::ImaAdpcm ? AlSampleType::ImaAdpcm : AlSampleType::MsAdpcm);
+		if (result.format == AL_NONE)
+		{
+			result = toPcm16();
+		}
+	}
+
+	if (result.format == AL_NONE)
+	{
+		throw std::invalid_argument("Unexpected format");
+	}
+
+	return result;
+}
+
+AlBufferData PrepareBufferData(
+	const AlFormatSupport& support,
+	size_t channels, size_t bitsPerSample,
+	const void* data, size_t dataSize,
+	SampleEncoding encoding,
+	size_t blockAlign,
+	std::vector<uint8_t>& converted)
+{
+	AlBufferData result = { ChooseAlFormat(support, channels, bitsPerSample, encoding), data, dataSize, 0 };
+
+	// Convert when the context can't take the samples as they are
+	if (IsAdpcm(encoding))
+	{
+		auto defaultBlockAlign = GetDefaultAdpcmBlockAlign(encoding, channels);
+		blockAlign = blockAlign == 0 ? defaultBlockAlign : blockAlign;
+		auto framesPerBlock = GetAdpcmFramesPerBlock(encoding, channels, blockAlign);
+
+		if (framesPerBlock == 0)
+		{
+			throw std::invalid_argument("Invalid ADPCM block layout");
+		}
+
+		// Other block sizes than the default need AL_SOFT_block_alignment
+		if (result.format.encoding == encoding && (blockAlign == defaultBlockAlign || support.blockAlignment))
+		{
+			if (support.blockAlignment)
+			{
+				result.framesPerBlock = framesPerBlock;
+			}
+
+			// OpenAL rejects partial blocks
+			result.dataSize -= dataSize % blockAlign;
+		}
+		else
+		{
+			DecodeAdpcm(encoding, channels, blockAlign, data, dataSize, converted);
+			result.format = ChooseAlFormat(support, channels, 16, SampleEncoding::Pcm);
+			result.data = converted.data();
+			result.dataSize = converted.size();
+		}
+	}
+	else if (result.format.encoding != encoding || result.format.bitsPerSample != bitsPerSample)
+	{
+		ConvertSamples(
+			encoding, bitsPerSample, data, dataSize,
+			result.format.encoding, result.format.bitsPerSample, converted);
+		result.data = converted.data();
+		result.dataSize = converted.size();
+	}
+
+	return result;
+}
+
+void UploadBufferData(
+	ALuint buffer,
+	size_t channels, size_t bitsPerSample, size_t sampleRate,
+	const void* data, size_t dataSize,
+	SampleEncoding encoding,
+	size_t blockAlign)
+{
+	std::vector<uint8_t> converted;
+	auto prepared = PrepareBufferData(
+		GetAlFormatSupport(),
+		channels, bitsPerSample,
+		data, dataSize,
+		encoding, blockAlign,
+		converted);
+
+	UploadBufferData(buffer, prepared, sampleRate);
+}
+
+void UploadBufferData(ALuint buffer, const AlBufferData& prepared, size_t sampleRate)
+{
+	// Files past 2 GB fit RF64 and Wave64 but not a single buffer
+	if (prepared.dataSize > static_cast<size_t>(std::numeric_limits<ALsizei>::max()))
+	{
+		throw std::length_error("The samples are too large for a sound buffer, stream them with StreamingSoundSource");
+	}
+
+	if (prepared.framesPerBlock != 0)
+	{
+		OpenAlCallVoidStrict(alBufferi,
+			buffer,
+			static_cast<ALenum>(AL_UNPACK_BLOCK_ALIGNMENT_SOFT),
+			static_cast<ALint>(prepared.framesPerBlock));
+	}
+
+	OpenAlCallVoidStrict(alBufferData,
+		buffer,
+		prepared.format.format, prepared.data,
+		static_cast<ALsizei>(prepared.dataSize),
+		static_cast<ALsizei>(sampleRate));
+}
+
+ALCenum ToAlcChannels(size_t channels)
+{
+	switch (channels)
+	{
+	case 1: return ALC_MONO_SOFT;
+	case 2: return ALC_STEREO_SOFT;
+	case 4: return ALC_QUAD_SOFT;
+	case 6: return ALC_5POINT1_SOFT;
+	case 7: return ALC_6POINT1_SOFT;
+	case 8: return ALC_7POINT1_SOFT;
+	}
+
+	throw std::invalid_argument("Unexpected channels count");
+}
+
+ALCenum ToAlcSampleType(SampleEncoding encoding, size_t bitsPerSample)
+{
+	if (encoding == SampleEncoding::Float && bitsPerSample == 32)
+	{
+		return ALC_FLOAT_SOFT;
+	}
+
+	if (encoding == SampleEncoding::Pcm)
+	{
+		// WAV keeps 8-bit samples unsigned and wider ones signed
+		switch (bitsPerSample)
+		{
+		case 8: return ALC_UNSIGNED_BYTE_SOFT;
+		case 16: return ALC_SHORT_SOFT;
+		case 32: return ALC_INT_SOFT;
+		}
+	}
+
+	throw std::invalid_argument("Unexpected format");
+}
\ No newline at end of file
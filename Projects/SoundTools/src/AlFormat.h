@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <AL/al.h>
+#include <AL/alc.h>
+
+#include "SoundTools/SampleEncoding.h"
+
+struct AlFormat
+{
+	ALenum format;
+	// Layout the samples have to be converted to before they are uploaded
+	SampleEncoding encoding;
+	size_t bitsPerSample;
+};
+
+// Format extensions of a context. Queried once, it can be used on threads
+// that don't own the context to prepare samples ahead of the upload.
+struct AlFormatSupport
+{
+	bool float32;
+	bool float64;
+	bool muLaw;
+	bool muLawMultichannel;
+	bool imaAdpcm;
+	bool msAdpcm;
+	bool blockAlignment;
+	bool multichannel;
+};
+
+// Samples ready for alBufferData, data points either at the source or at the converted vector
+struct AlBufferData
+{
+	AlFormat format;
+	const void* data;
+	size_t dataSize;
+	// Non-zero when ADPCM stays compressed with a block size other than the default
+	size_t framesPerBlock;
+};
+
+AlFormatSupport GetAlFormatSupport();
+
+// Picks the closest format the current context accepts, preferring direct uploads
+AlFormat ChooseAlFormat(size_t channels, size_t bitsPerSample, SampleEncoding encoding);
+AlFormat ChooseAlFormat(const AlFormatSupport& support, size_t channels, size_t bitsPerSample, SampleEncoding encoding);
+
+// Converts the samples to the chosen format when needed, makes no OpenAL calls
+AlBufferData PrepareBufferData(
+	const AlFormatSupport& support,
+	size_t channels, size_t bitsPerSample,
+	const void* data, size_t dataSize,
+	SampleEncoding encoding,
+	size_t blockAlign,
+	std::vector<uint8_t>& converted);
+
+// Converts the samples to the chosen format when needed and fills the buffer.
+// ADPCM stays compressed when the context supports the format and block size,
+// a zero blockAlign means the default block size.
+void UploadBufferData(
+	ALuint buffer,
+	size_t channels, size_t bitsPerSample, size_t sampleRate,
+	const void* data, size_t dataSize,
+	SampleEncoding encoding,
+	size_t blockAlign = 0);
+
+// Fills the buffer with samples PrepareBufferData made ready, makes no other OpenAL calls
+void UploadBufferData(ALuint buffer, const AlBufferData& prepared, size_t sampleRate);
+
+// Channel configuration and sample type enums of ALC_SOFT_loopback
+ALCenum ToAlcChannels(size_t channels);
+ALCenum ToAlcSampleType(SampleEncoding encoding, size_t bitsPerSample);
\ No newline at end of file
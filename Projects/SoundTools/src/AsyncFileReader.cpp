@@ -0,0 +1,435 @@
+#include "AsyncFileReader.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingPool.h"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <cerrno>
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+	// Only opening blocks on Windows, the reads themselves are overlapped
+	constexpr size_t openThreadsCount = 2;
+#endif
+
+	struct PendingFile
+	{
+		PendingFile(const char* filename, AsyncFileReader::Callback&& onRead) :
+			filename(filename),
+			onRead(std::move(onRead)),
+#ifdef _WIN32
+			handle(INVALID_HANDLE_VALUE),
+#else
+			fd(-1),
+#endif
+			size(0),
+			remaining(0),
+			failed(false)
+		{}
+
+		~PendingFile()
+		{
+			Close();
+		}
+
+		void Open()
+		{
+#ifdef _WIN32
+			handle = CreateFileA(
+				filename.c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN,
+				nullptr);
+
+			if (handle == INVALID_HANDLE_VALUE)
+			{
+				throw std::invalid_argument("Failed to open the file");
+			}
+
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(handle, &fileSize) ||
+				static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX)
+			{
+				throw std::runtime_error("Could not read the file");
+			}
+
+			size = static_cast<size_t>(fileSize.QuadPart);
+#else
+			fd = open(filename.c_str(), O_RDONLY);
+
+			if (fd < 0)
+			{
+				throw std::invalid_argument("Failed to open the file");
+			}
+
+			struct stat fileStat;
+			if (fstat(fd, &fileStat) != 0)
+			{
+				throw std::runtime_error("Could not read the file");
+			}
+
+			size = static_cast<size_t>(fileStat.st_size);
+
+	#ifdef POSIX_FADV_WILLNEED
+			posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+			posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+	#endif
+#endif
+		}
+
+		void Close()
+		{
+#ifdef _WIN32
+			if (handle != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(handle);
+				handle = INVALID_HANDLE_VALUE;
+			}
+#else
+			if (fd >= 0)
+			{
+				close(fd);
+				fd = -1;
+			}
+#endif
+		}
+
+		std::string filename;
+		AsyncFileReader::Callback onRead;
+#ifdef _WIN32
+		HANDLE handle;
+#else
+		int fd;
+#endif
+		std::unique_ptr<uint8_t[]> data;
+		size_t size;
+		// Chunks not read yet and whether any of them failed, guarded by the reader mutex
+		size_t remaining;
+		bool failed;
+	};
+
+	struct Chunk
+	{
+#ifdef _WIN32
+		// Completions hand back its address
+		OVERLAPPED overlapped;
+#endif
+		std::shared_ptr<PendingFile> file;
+		uint64_t offset;
+		size_t size;
+	};
+}
+
+class AsyncFileReader::Impl
+{
+public:
+	Impl(size_t queueDepth, size_t chunkSize) :
+		queueDepth(std::max<size_t>(queueDepth, 1)),
+		chunkSize(std::max<size_t>(chunkSize, 1)),
+		inFlight(0),
+		opening(0),
+		exit(false),
+#ifdef _WIN32
+		port(CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1)),
+		pool(openThreadsCount)
+#else
+		pool(this->queueDepth)
+#endif
+	{
+#ifdef _WIN32
+		if (port == nullptr)
+		{
+			throw std::runtime_error("Could not create an I/O completion port");
+		}
+
+		completionThread = std::thread([this]()
+		{
+			RunCompletions();
+		});
+#endif
+	}
+
+	~Impl()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		exit = true;
+		pending.clear();
+
+		// The buffers of the reads in flight must outlive them, files being opened may still use the port
+		idle.wait(lock, [this]() { return inFlight == 0 && opening == 0; });
+		lock.unlock();
+
+#ifdef _WIN32
+		PostQueuedCompletionStatus(port, 0, 0, nullptr);
+		completionThread.join();
+		CloseHandle(port);
+#endif
+	}
+
+	// Runs on the pool, opening can take as long as a read
+	void Open(const std::shared_ptr<PendingFile>& file)
+	{
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+
+			// Files not opened before the reader is destroyed are dropped without their callbacks
+			if (exit)
+			{
+				return;
+			}
+
+			++opening;
+		}
+
+		std::string error;
+
+		try
+		{
+			file->Open();
+#ifdef _WIN32
+			if (CreateIoCompletionPort(file->handle, port, 0, 0) == nullptr)
+			{
+				throw std::runtime_error("Could not read the file");
+			}
+#endif
+			file->data.reset(new uint8_t[std::max<size_t>(file->size, 1)]);
+		}
+		catch (const std::exception& ex)
+		{
+			error = ex.what();
+		}
+
+		std::vector<Chunk> started;
+
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+
+			if (--opening == 0 && inFlight == 0)
+			{
+				idle.notify_all();
+			}
+
+			if (exit)
+			{
+				file->Close();
+				return;
+			}
+
+			if (!error.empty() || file->size == 0)
+			{
+				file->Close();
+			}
+			else
+			{
+				QueueChunks(file);
+				TakeStartable(started);
+			}
+		}
+
+		if (!error.empty())
+		{
+			file->onRead(nullptr, 0, error.c_str());
+		}
+		else if (file->size == 0)
+		{
+			file->onRead(std::move(file->data), 0, nullptr);
+		}
+		else
+		{
+			Start(started);
+		}
+	}
+
+	// Splits the file into chunks at the end of the queue, with the mutex held
+	void QueueChunks(const std::shared_ptr<PendingFile>& file)
+	{
+		for (uint64_t offset = 0; offset < file->size; offset += chunkSize)
+		{
+			Chunk chunk = {};
+			chunk.file = file;
+			chunk.offset = offset;
+			chunk.size = static_cast<size_t>(std::min<uint64_t>(chunkSize, file->size - offset));
+			pending.push_back(std::move(chunk));
+			++file->remaining;
+		}
+	}
+
+	// Moves the chunks that fit into the queue depth to chunks, with the mutex held
+	void TakeStartable(std::vector<Chunk>& chunks)
+	{
+		while (!exit && inFlight < queueDepth && !pending.empty())
+		{
+			chunks.push_back(std::move(pending.front()));
+			pending.pop_front();
+			++inFlight;
+		}
+	}
+
+	void Start(std::vector<Chunk>& chunks)
+	{
+		for (auto& chunk : chunks)
+		{
+#ifdef _WIN32
+			auto request = new Chunk(std::move(chunk));
+			auto& file = *request->file;
+			request->overlapped.Offset = static_cast<DWORD>(request->offset);
+			request->overlapped.OffsetHigh = static_cast<DWORD>(request->offset >> 32);
+
+			if (!ReadFile(file.handle, file.data.get() + request->offset, static_cast<DWORD>(request->size), nullptr, &request->overlapped) &&
+				GetLastError() != ERROR_IO_PENDING)
+			{
+				Complete(*request, false);
+				delete request;
+			}
+#else
+			pool.Submit([this, chunk]()
+			{
+				auto& file = *chunk.file;
+				size_t done = 0;
+
+				while (done < chunk.size)
+				{
+					auto read = pread(file.fd, file.data.get() + chunk.offset + done, chunk.size - done, static_cast<off_t>(chunk.offset + done));
+
+					if (read < 0 && errno == EINTR)
+					{
+						continue;
+					}
+
+					if (read <= 0)
+					{
+						break;
+					}
+
+					done += static_cast<size_t>(read);
+				}
+
+				Complete(chunk, done == chunk.size);
+			});
+#endif
+		}
+	}
+
+	void Complete(const Chunk& chunk, bool succeeded)
+	{
+		std::shared_ptr<PendingFile> finished;
+		std::vector<Chunk> started;
+
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			--inFlight;
+
+			auto& file = *chunk.file;
+			file.failed = file.failed || !succeeded;
+
+			if (--file.remaining == 0)
+			{
+				finished = chunk.file;
+			}
+
+			TakeStartable(started);
+
+			if (inFlight == 0 && opening == 0)
+			{
+				idle.notify_all();
+			}
+		}
+
+		Start(started);
+
+		if (finished != nullptr)
+		{
+			finished->Close();
+
+			if (finished->failed)
+			{
+				finished->onRead(nullptr, 0, "Could not read the file");
+			}
+			else
+			{
+				finished->onRead(std::move(finished->data), finished->size, nullptr);
+			}
+		}
+	}
+
+#ifdef _WIN32
+	void RunCompletions()
+	{
+		while (true)
+		{
+			DWORD transferred = 0;
+			ULONG_PTR key = 0;
+			OVERLAPPED* overlapped = nullptr;
+			auto succeeded = GetQueuedCompletionStatus(port, &transferred, &key, &overlapped, INFINITE);
+
+			// A packet without an overlapped request asks the thread to stop
+			if (overlapped == nullptr)
+			{
+				return;
+			}
+
+			std::unique_ptr<Chunk> chunk(CONTAINING_RECORD(overlapped, Chunk, overlapped));
+			Complete(*chunk, succeeded && transferred == chunk->size);
+		}
+	}
+#endif
+
+	size_t queueDepth;
+	size_t chunkSize;
+	std::mutex mutex;
+	std::condition_variable idle;
+	std::deque<Chunk> pending;
+	size_t inFlight;
+	// Files between the exit check and the queueing of their chunks
+	size_t opening;
+	bool exit;
+#ifdef _WIN32
+	HANDLE port;
+	std::thread completionThread;
+#endif
+	// Declared last so running tasks finish before the rest goes away
+	WorkStealingPool pool;
+};
+
+AsyncFileReader::AsyncFileReader(size_t queueDepth, size_t chunkSize) :
+	m_d(std::make_unique<Impl>(queueDepth, chunkSize))
+{
+}
+
+AsyncFileReader::~AsyncFileReader() = default;
+
+void AsyncFileReader::Read(const char* filename, Callback onRead)
+{
+	if (filename == nullptr)
+	{
+		throw std::invalid_argument("File name can't be null");
+	}
+
+	auto file = std::make_shared<PendingFile>(filename, std::move(onRead));
+	auto impl = m_d.get();
+
+	m_d->pool.Submit([impl, file]()
+	{
+		impl->Open(file);
+	});
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+// Reads whole files without blocking the caller. Files are split into chunks and up to
+// queueDepth chunk reads are kept in flight across all files: overlapped reads completed
+// on an I/O completion port on Windows, pread on a pool of queueDepth threads elsewhere.
+// Each file is announced as read sequentially, so the readahead starts with the first chunk.
+class AsyncFileReader
+{
+public:
+	// error is null on success. Called from an I/O thread.
+	using Callback = std::function<void(std::unique_ptr<uint8_t[]>&& data, size_t size, const char* error)>;
+
+	AsyncFileReader(size_t queueDepth, size_t chunkSize);
+	AsyncFileReader(const AsyncFileReader&) = delete;
+	// Waits for the reads in flight, files not read yet are dropped without their callbacks
+	~AsyncFileReader();
+
+	void Read(const char* filename, Callback onRead);
+
+	AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_d;
+};
\ No newline at end of file
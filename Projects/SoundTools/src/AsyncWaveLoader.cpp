@@ -0,0 +1,69 @@
+#include <stdexcept>
+
+#include "AsyncFileReader.h"
+
+#include "SoundTools/AsyncWaveLoader.h"
+
+class AsyncWaveLoader::Impl
+{
+public:
+	Impl(size_t queueDepth, size_t chunkSize) :
+		reader(queueDepth, chunkSize)
+	{}
+
+	AsyncFileReader reader;
+};
+
+AsyncWaveLoader::AsyncWaveLoader(size_t queueDepth, size_t chunkSize) :
+	m_d(std::make_unique<Impl>(queueDepth, chunkSize))
+{
+}
+
+AsyncWaveLoader::~AsyncWaveLoader() = default;
+
+void AsyncWaveLoader::Load(const char* filename, WaveLoadCallback onLoaded)
+{
+	m_d->reader.Read(filename, [onLoaded](std::unique_ptr<uint8_t[]>&& data, size_t size, const char* error)
+	{
+		if (error != nullptr)
+		{
+			onLoaded(nullptr, error);
+			return;
+		}
+
+		// Parsed where it was read, the samples stay in the buffer they were read into
+		std::unique_ptr<WaveBuffer> wave;
+
+		try
+		{
+			wave = std::make_unique<WaveBuffer>(std::move(data), size);
+		}
+		catch (const std::exception& ex)
+		{
+			onLoaded(nullptr, ex.what());
+			return;
+		}
+
+		onLoaded(std::move(wave), nullptr);
+	});
+}
+
+std::future<WaveBuffer> AsyncWaveLoader::Load(const char* filename)
+{
+	auto promise = std::make_shared<std::promise<WaveBuffer>>();
+	auto result = promise->get_future();
+
+	Load(filename, [promise](std::unique_ptr<WaveBuffer> wave, const char* error)
+	{
+		if (wave != nullptr)
+		{
+			promise->set_value(std::move(*wave));
+		}
+		else
+		{
+			promise->set_exception(std::make_exception_ptr(std::runtime_error(error)));
+		}
+	});
+
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// FNV-1a over 64-bit words, with the tail folded in byte by byte
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull)
+{
+	constexpr uint64_t prime = 1099511628211ull;
+
+	auto bytes = static_cast<const uint8_t*>(data);
+	auto hash = seed;
+	size_t i = 0;
+
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+	{
+		uint64_t word;
+		std::memcpy(&word, bytes + i, sizeof(word));
+		hash = (hash ^ word) * prime;
+	}
+
+	for (; i < size; ++i)
+	{
+		hash = (hash ^ bytes[i]) * prime;
+	}
+
+	return hash;
+}
\ No newline at end of file
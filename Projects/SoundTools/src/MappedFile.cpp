@@ -0,0 +1,123 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const char* filename) :
+	m_data(nullptr),
+	m_size(0),
+	m_file(INVALID_HANDLE_VALUE),
+	m_mapping(nullptr)
+{
+	m_file = CreateFileA(
+		filename,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		nullptr);
+
+	if (m_file == INVALID_HANDLE_VALUE)
+	{
+		throw std::invalid_argument("Failed to open the file");
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0 ||
+		static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX)
+	{
+		CloseHandle(m_file);
+		throw std::runtime_error("Could not map the file");
+	}
+
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr)
+	{
+		CloseHandle(m_file);
+		throw std::runtime_error("Could not map the file");
+	}
+
+	m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr)
+	{
+		CloseHandle(m_mapping);
+		CloseHandle(m_file);
+		throw std::runtime_error("Could not map the file");
+	}
+
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mapping);
+	CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const char* filename) :
+	m_data(nullptr),
+	m_size(0)
+{
+	int fd = open(filename, O_RDONLY);
+
+	if (fd < 0)
+	{
+		throw std::invalid_argument("Failed to open the file");
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		close(fd);
+		throw std::runtime_error("Could not map the file");
+	}
+
+	auto size = static_cast<size_t>(fileStat.st_size);
+	auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping keeps its own reference to the file
+	close(fd);
+
+	if (data == MAP_FAILED)
+	{
+		throw std::runtime_error("Could not map the file");
+	}
+
+	madvise(data, size, MADV_SEQUENTIAL);
+
+	m_data = static_cast<const uint8_t*>(data);
+	m_size = size;
+}
+
+MappedFile::~MappedFile()
+{
+	munmap(const_cast<uint8_t*>(m_data), m_size);
+}
+
+#endif
+
+const uint8_t* MappedFile::GetData() const
+{
+	return m_data;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return m_size;
+}
\ No newline at end of file
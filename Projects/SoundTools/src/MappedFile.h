@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class MappedFile
+{
+public:
+	MappedFile(const char* filename);
+	MappedFile(const MappedFile&) = delete;
+	~MappedFile();
+
+	const uint8_t* GetData() const;
+	size_t GetSize() const;
+
+	MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+	const uint8_t* m_data;
+	size_t m_size;
+#ifdef _WIN32
+	void* m_file;
+	void* m_mapping;
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <streambuf>
+
+// Read-only, seekable stream buffer over bytes in memory, so the stream parsers
+// can run on files that were read some other way
+class MemoryStreamBuffer : public std::streambuf
+{
+public:
+	MemoryStreamBuffer(const uint8_t* data, size_t size)
+	{
+		auto begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+		setg(begin, begin, begin + size);
+	}
+
+protected:
+	pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+	{
+		if ((which & std::ios_base::in) == 0)
+		{
+			return pos_type(off_type(-1));
+		}
+
+		off_type base = 0;
+		if (dir == std::ios_base::cur)
+		{
+			base = gptr() - eback();
+		}
+		else if (dir == std::ios_base::end)
+		{
+			base = egptr() - eback();
+		}
+
+		auto position = base + offset;
+		if (position < 0 || position > egptr() - eback())
+		{
+			return pos_type(off_type(-1));
+		}
+
+		setg(eback(), eback() + position, egptr());
+		return pos_type(position);
+	}
+
+	pos_type seekpos(pos_type position, std::ios_base::openmode which) override
+	{
+		return seekoff(off_type(position), std::ios_base::beg, which);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include <algorithm>
+
+#include "MixerKernels.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#define SOUND_TOOLS_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace
+{
+	float Interpolate(const float* src, size_t srcFrames, size_t srcChannels, size_t channel, double position)
+	{
+		auto index = static_cast<size_t>(position);
+		auto next = std::min(index + 1, srcFrames - 1);
+		auto fraction = static_cast<float>(position - static_cast<double>(index));
+
+		auto a = src[index * srcChannels + channel];
+		auto b = src[next * srcChannels + channel];
+
+		return a + (b - a) * fraction;
+	}
+
+#ifdef SOUND_TOOLS_SSE2
+	// Four interpolated mono frames starting at frame i
+	__m128 InterpolateMono4(const float* src, size_t srcFrames, double position, double step, size_t i)
+	{
+		float a[4], b[4], fractions[4];
+
+		for (size_t k = 0; k < 4; ++k)
+		{
+			auto p = position + static_cast<double>(i + k) * step;
+			auto index = static_cast<size_t>(p);
+
+			a[k] = src[index];
+			b[k] = src[std::min(index + 1, srcFrames - 1)];
+			fractions[k] = static_cast<float>(p - static_cast<double>(index));
+		}
+
+		auto va = _mm_loadu_ps(a);
+		auto vb = _mm_loadu_ps(b);
+		return _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), _mm_loadu_ps(fractions)));
+	}
+#endif
+}
+
+void MixAdd(const float* src, float* dst, size_t count, float gain)
+{
+	size_t i = 0;
+
+#ifdef SOUND_TOOLS_SSE2
+	auto vgain = _mm_set1_ps(gain);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		auto low = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), vgain));
+		auto high = _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_mul_ps(_mm_loadu_ps(src + i + 4), vgain));
+		_mm_storeu_ps(dst + i, low);
+		_mm_storeu_ps(dst + i + 4, high);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		dst[i] += src[i] * gain;
+	}
+}
+
+double MixResampled(
+	const float* src, size_t srcFrames, size_t srcChannels,
+	double position, double step,
+	float* dst, size_t dstFrames, size_t dstChannels,
+	float gain)
+{
+	size_t i = 0;
+
+#ifdef SOUND_TOOLS_SSE2
+	// Mono sources cover the common case of many one-shot effects
+	if (srcChannels == 1 && (dstChannels == 1 || dstChannels == 2))
+	{
+		auto vgain = _mm_set1_ps(gain);
+
+		for (; i + 4 <= dstFrames; i += 4)
+		{
+			auto v = _mm_mul_ps(InterpolateMono4(src, srcFrames, position, step, i), vgain);
+
+			if (dstChannels == 1)
+			{
+				_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), v));
+			}
+			else
+			{
+				auto out = dst + i * 2;
+				_mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_unpacklo_ps(v, v)));
+				_mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_unpackhi_ps(v, v)));
+			}
+		}
+	}
+#endif
+
+	for (; i < dstFrames; ++i)
+	{
+		auto p = position + static_cast<double>(i) * step;
+		auto out = dst + i * dstChannels;
+
+		if (srcChannels == 1)
+		{
+			auto sample = Interpolate(src, srcFrames, 1, 0, p) * gain;
+
+			for (size_t c = 0; c < dstChannels; ++c)
+			{
+				out[c] += sample;
+			}
+		}
+		else if (dstChannels == 1)
+		{
+			float sum = 0;
+
+			for (size_t c = 0; c < srcChannels; ++c)
+			{
+				sum += Interpolate(src, srcFrames, srcChannels, c, p);
+			}
+
+			out[0] += sum * gain / static_cast<float>(srcChannels);
+		}
+		else
+		{
+			auto channels = std::min(srcChannels, dstChannels);
+
+			for (size_t c = 0; c < channels; ++c)
+			{
+				out[c] += Interpolate(src, srcFrames, srcChannels, c, p) * gain;
+			}
+		}
+	}
+
+	return position + static_cast<double>(dstFrames) * step;
+}
\ No newline at end of file
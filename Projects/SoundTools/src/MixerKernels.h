@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+// dst[i] += src[i] * gain
+void MixAdd(const float* src, float* dst, size_t count, float gain);
+
+// Adds dstFrames frames read from src at position, position + step, ... with linear
+// interpolation. Mono sources are spread to every channel, extra source channels are
+// dropped and a mono destination gets the average. Returns the position after the last frame.
+double MixResampled(
+	const float* src, size_t srcFrames, size_t srcChannels,
+	double position, double step,
+	float* dst, size_t dstFrames, size_t dstChannels,
+	float gain);
\ No newline at end of file
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+
+// Unbounded multi-producer single-consumer queue. Push never blocks or locks,
+// producers only exchange the head pointer. Pop and IsEmpty are consumer-only.
+// Nodes come from a preallocated pool and go back to it once popped, pushes
+// only allocate while the whole pool is queued.
+template<typename T>
+class MpscQueue
+{
+public:
+	MpscQueue(size_t poolSize = 1024) :
+		m_head(new Node()),
+		m_tail(m_head.load()),
+		m_pool(new Node[poolSize]),
+		m_freeHead(poolSize != 0 ? 1 : 0)
+	{
+		// Free links hold the index plus one, zero ends the list
+		for (size_t i = 0; i < poolSize; ++i)
+		{
+			m_pool[i].poolIndex = static_cast<uint32_t>(i);
+			m_pool[i].nextFree.store(i + 1 < poolSize ? static_cast<uint32_t>(i + 2) : 0, std::memory_order_relaxed);
+		}
+	}
+
+	MpscQueue(const MpscQueue&) = delete;
+
+	~MpscQueue()
+	{
+		while (m_tail != nullptr)
+		{
+			auto next = m_tail->next.load(std::memory_order_relaxed);
+			if (m_tail->poolIndex == heapNode)
+			{
+				delete m_tail;
+			}
+			m_tail = next;
+		}
+	}
+
+	void Push(T&& value)
+	{
+		auto node = Allocate(std::move(value));
+		auto previous = m_head.exchange(node, std::memory_order_acq_rel);
+		previous->next.store(node, std::memory_order_release);
+	}
+
+	bool Pop(T& value)
+	{
+		auto next = m_tail->next.load(std::memory_order_acquire);
+
+		if (next == nullptr)
+		{
+			return false;
+		}
+
+		// The popped node becomes the new stub
+		value = std::move(next->value);
+		Free(m_tail);
+		m_tail = next;
+
+		return true;
+	}
+
+	bool IsEmpty() const
+	{
+		return m_tail->next.load(std::memory_order_acquire) == nullptr;
+	}
+
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+private:
+	static constexpr uint32_t heapNode = std::numeric_limits<uint32_t>::max();
+
+	struct Node
+	{
+		Node() :
+			next(nullptr),
+			poolIndex(heapNode),
+			nextFree(0)
+		{}
+
+		Node(T&& value) :
+			next(nullptr),
+			value(std::move(value)),
+			poolIndex(heapNode),
+			nextFree(0)
+		{}
+
+		std::atomic<Node*> next;
+		T value;
+		uint32_t poolIndex;
+		std::atomic<uint32_t> nextFree;
+	};
+
+	// The free list head packs a version above the link, so a node popped
+	// and pushed back between a load and a compare doesn't pass for unchanged
+	static uint64_t MakeFreeHead(uint64_t previous, uint32_t link)
+	{
+		return ((previous >> 32) + 1) << 32 | link;
+	}
+
+	Node* Allocate(T&& value)
+	{
+		auto head = m_freeHead.load(std::memory_order_acquire);
+
+		while (static_cast<uint32_t>(head) != 0)
+		{
+			auto& node = m_pool[static_cast<uint32_t>(head) - 1];
+			auto next = MakeFreeHead(head, node.nextFree.load(std::memory_order_relaxed));
+
+			if (m_freeHead.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+			{
+				node.next.store(nullptr, std::memory_order_relaxed);
+				node.value = std::move(value);
+				return &node;
+			}
+		}
+
+		return new Node(std::move(value));
+	}
+
+	// Consumer only
+	void Free(Node* node)
+	{
+		if (node->poolIndex == heapNode)
+		{
+			delete node;
+			return;
+		}
+
+		// Whatever the value still holds is released now rather than on reuse
+		node->value = T();
+
+		auto head = m_freeHead.load(std::memory_order_relaxed);
+		uint64_t next;
+
+		do
+		{
+			node->nextFree.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+			next = MakeFreeHead(head, node->poolIndex + 1);
+		}
+		while (!m_freeHead.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	std::atomic<Node*> m_head;
+	Node* m_tail;
+	std::unique_ptr<Node[]> m_pool;
+	std::atomic<uint64_t> m_freeHead;
+};
\ No newline at end of file
@@ -0,0 +1,23 @@
+#include <limits>
+
+#include "SoundTools/NullSoundBackend.h"
+
+NullSoundBackend::NullSoundBackend() :
+	m_writtenFrames(0)
+{
+}
+
+size_t NullSoundBackend::GetWritableFrames()
+{
+	return std::numeric_limits<size_t>::max();
+}
+
+void NullSoundBackend::Write(const float*, size_t framesCount)
+{
+	m_writtenFrames += framesCount;
+}
+
+size_t NullSoundBackend::GetWrittenFrames() const
+{
+	return m_writtenFrames;
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <vector>
+
+#include "AlFormat.h"
+#include "OpenAlTools.h"
+#include "SampleConversion.h"
+
+#include "SoundTools/OpenAlSoundBackend.h"
+
+class OpenAlSoundBackend::Impl
+{
+public:
+	Impl(size_t channelsCount, size_t sampleRate, size_t blockFrames, size_t buffersCount) :
+		channelsCount(channelsCount),
+		sampleRate(sampleRate),
+		blockFrames(blockFrames),
+		format(ChooseAlFormat(channelsCount, 32, SampleEncoding::Float)),
+		sourceId(alInvalidId)
+	{
+		if (sampleRate == 0 || blockFrames == 0)
+		{
+			throw std::invalid_argument("Invalid backend format");
+		}
+
+		if (buffersCount < 2)
+		{
+			throw std::invalid_argument("Streaming needs at least two buffers");
+		}
+
+		buffers.resize(buffersCount, alInvalidId);
+		OpenAlCallVoidStrict(alGenBuffers, static_cast<ALsizei>(buffers.size()), buffers.data());
+
+		try
+		{
+			OpenAlCallVoidStrict(alGenSources, 1, &sourceId);
+		}
+		catch (...)
+		{
+			alDeleteBuffers(static_cast<ALsizei>(buffers.size()), buffers.data());
+			throw;
+		}
+
+		// The mix is already spatialized, play it as is
+		alSourcei(sourceId, AL_SOURCE_RELATIVE, AL_TRUE);
+		alSource3f(sourceId, AL_POSITION, 0, 0, 0);
+
+		freeBuffers = buffers;
+	}
+
+	~Impl()
+	{
+		alSourceStop(sourceId);
+		alSourcei(sourceId, AL_BUFFER, 0);
+		alDeleteSources(1, &sourceId);
+		alDeleteBuffers(static_cast<ALsizei>(buffers.size()), buffers.data());
+	}
+
+	void Reclaim()
+	{
+		ALint processed = 0;
+		OpenAlCallVoid(alGetSourcei, sourceId, static_cast<ALenum>(AL_BUFFERS_PROCESSED), &processed);
+
+		while (processed-- > 0)
+		{
+			ALuint buffer;
+			OpenAlCallVoid(alSourceUnqueueBuffers, sourceId, static_cast<ALsizei>(1), &buffer);
+			freeBuffers.push_back(buffer);
+		}
+	}
+
+	void QueueBlock(const float* samples)
+	{
+		const void* data = samples;
+		auto dataSize = blockFrames * channelsCount * sizeof(float);
+
+		if (format.encoding != SampleEncoding::Float || format.bitsPerSample != 32)
+		{
+			ConvertSamples(
+				SampleEncoding::Float, 32, data, dataSize,
+				format.encoding, format.bitsPerSample, converted);
+			data = converted.data();
+			dataSize = converted.size();
+		}
+
+		auto buffer = freeBuffers.back();
+		OpenAlCallVoid(alBufferData,
+			buffer, format.format, data,
+			static_cast<ALsizei>(dataSize),
+			static_cast<ALsizei>(sampleRate));
+		OpenAlCallVoid(alSourceQueueBuffers, sourceId, static_cast<ALsizei>(1), static_cast<const ALuint*>(&buffer));
+		freeBuffers.pop_back();
+	}
+
+	size_t channelsCount;
+	size_t sampleRate;
+	size_t blockFrames;
+	AlFormat format;
+	ALuint sourceId;
+	std::vector<ALuint> buffers;
+	std::vector<ALuint> freeBuffers;
+	// Frames that don't fill a whole block yet
+	std::vector<float> pending;
+	std::vector<uint8_t> converted;
+};
+
+OpenAlSoundBackend::OpenAlSoundBackend(
+	size_t channelsCount,
+	size_t sampleRate,
+	size_t blockFrames,
+	size_t buffersCount) :
+	m_d(std::make_unique<Impl>(channelsCount, sampleRate, blockFrames, buffersCount))
+{
+}
+
+OpenAlSoundBackend::~OpenAlSoundBackend() = default;
+
+size_t OpenAlSoundBackend::GetWritableFrames()
+{
+	m_d->Reclaim();
+
+	auto capacity = m_d->freeBuffers.size() * m_d->blockFrames;
+	auto pendingFrames = m_d->pending.size() / m_d->channelsCount;
+
+	return capacity > pendingFrames ? capacity - pendingFrames : 0;
+}
+
+void OpenAlSoundBackend::Write(const float* frames, size_t framesCount)
+{
+	m_d->Reclaim();
+	m_d->pending.insert(m_d->pending.end(), frames, frames + framesCount * m_d->channelsCount);
+
+	auto blockSamples = m_d->blockFrames * m_d->channelsCount;
+	size_t consumed = 0;
+
+	while (m_d->pending.size() - consumed >= blockSamples && !m_d->freeBuffers.empty())
+	{
+		m_d->QueueBlock(m_d->pending.data() + consumed);
+		consumed += blockSamples;
+	}
+
+	m_d->pending.erase(m_d->pending.begin(), m_d->pending.begin() + consumed);
+
+	// Start again after the first blocks or after an underrun
+	ALint state, queued;
+	OpenAlCallVoid(alGetSourcei, m_d->sourceId, static_cast<ALenum>(AL_SOURCE_STATE), &state);
+	OpenAlCallVoid(alGetSourcei, m_d->sourceId, static_cast<ALenum>(AL_BUFFERS_QUEUED), &queued);
+
+	if (state != AL_PLAYING && queued > 0)
+	{
+		OpenAlCallVoid(alSourcePlay, m_d->sourceId);
+	}
+}
\ No newline at end of file
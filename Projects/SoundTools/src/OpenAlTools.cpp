@@ -0,0 +1,154 @@
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "OpenAlTools.h"
+
+namespace
+{
+	struct DeferredBatch
+	{
+		std::mutex mutex;
+		OpenAlCallSite first;
+		size_t callsCount;
+		// Taken by a fully checked call while the batch was pending
+		ALenum error;
+	};
+
+	std::mutex batchesMutex;
+	std::unordered_map<ALCcontext*, std::shared_ptr<DeferredBatch>> batches;
+	// Bumped when a context is forgotten, so threads look their batch up again
+	std::atomic<uint64_t> batchesEpoch(0);
+
+	struct CachedBatch
+	{
+		ALCcontext* context;
+		uint64_t epoch;
+		std::shared_ptr<DeferredBatch> batch;
+	};
+
+	thread_local CachedBatch cachedBatch = { nullptr, 0, nullptr };
+
+	DeferredBatch& GetDeferredBatch()
+	{
+		auto context = alcGetCurrentContext();
+		auto epoch = batchesEpoch.load(std::memory_order_acquire);
+
+		if (cachedBatch.batch == nullptr || cachedBatch.context != context || cachedBatch.epoch != epoch)
+		{
+			std::lock_guard<std::mutex> guard(batchesMutex);
+			auto& batch = batches[context];
+
+			if (batch == nullptr)
+			{
+				batch = std::make_shared<DeferredBatch>();
+				batch->first = OpenAlCallSite{ nullptr, 0, nullptr };
+				batch->callsCount = 0;
+				batch->error = AL_NO_ERROR;
+			}
+
+			cachedBatch = CachedBatch{ context, epoch, batch };
+		}
+
+		return *cachedBatch.batch;
+	}
+
+	[[noreturn]] void ThrowOpenAlError(ALenum error, const OpenAlCallSite& site, const char* details)
+	{
+		std::string message = alGetString(error);
+		message += details;
+		message += site.function;
+		message += " at ";
+		message += site.file;
+		message += ':';
+		message += std::to_string(site.line);
+
+		throw std::runtime_error(message);
+	}
+}
+
+void OpenAlFullCheck::AfterCall(const OpenAlCallSite& site)
+{
+	auto error = alGetError();
+
+	if (error == AL_NO_ERROR)
+	{
+		return;
+	}
+
+	{
+		auto& batch = GetDeferredBatch();
+		std::lock_guard<std::mutex> guard(batch.mutex);
+
+		// AL keeps the first error, with a batch pending it most likely came from the batch
+		if (batch.callsCount != 0)
+		{
+			if (batch.error == AL_NO_ERROR)
+			{
+				batch.error = error;
+			}
+
+			return;
+		}
+	}
+
+	ThrowOpenAlError(error, site, " in ");
+}
+
+void OpenAlFullCheck::Flush()
+{
+	// Calls that are batched in any build leave their errors for the flush
+	OpenAlDeferredCheck::Flush();
+}
+
+void OpenAlDeferredCheck::AfterCall(const OpenAlCallSite& site)
+{
+	auto& batch = GetDeferredBatch();
+	std::lock_guard<std::mutex> guard(batch.mutex);
+
+	if (batch.callsCount++ == 0)
+	{
+		batch.first = site;
+	}
+}
+
+void OpenAlDeferredCheck::Flush()
+{
+	auto& batch = GetDeferredBatch();
+
+	OpenAlCallSite first;
+	size_t callsCount;
+	ALenum error;
+
+	{
+		std::lock_guard<std::mutex> guard(batch.mutex);
+		first = batch.first;
+		callsCount = batch.callsCount;
+		error = batch.error != AL_NO_ERROR ? batch.error : alGetError();
+
+		batch.callsCount = 0;
+		batch.error = AL_NO_ERROR;
+	}
+
+	if (error == AL_NO_ERROR)
+	{
+		return;
+	}
+
+	if (callsCount == 0)
+	{
+		throw std::runtime_error(alGetString(error));
+	}
+
+	auto details = " in a batch of " + std::to_string(callsCount) + " calls starting with ";
+	ThrowOpenAlError(error, first, details.c_str());
+}
+
+void OpenAlForgetContext(ALCcontext* context)
+{
+	std::lock_guard<std::mutex> guard(batchesMutex);
+	batches.erase(context);
+	batchesEpoch.fetch_add(1, std::memory_order_release);
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <limits>
 #include <stdexcept>
 
 #include <AL/al.h>
@@ -7,30 +8,99 @@
 
 static constexpr auto alInvalidId = std::numeric_limits<ALuint>::max();
 
-template<typename Ret, typename... Args>
-Ret OpenAlCall(Ret(*fn)(Args...), Args... args)
+#define SOUND_TOOLS_AL_CHECK_FULL 0
+#define SOUND_TOOLS_AL_CHECK_DEFERRED 1
+#define SOUND_TOOLS_AL_CHECK_NONE 2
+
+// Defaults to full checking in debug builds and deferred checking otherwise
+#ifndef SOUND_TOOLS_AL_CHECK
+	#if defined(_DEBUG) || (!defined(_MSC_VER) && !defined(NDEBUG))
+		#define SOUND_TOOLS_AL_CHECK SOUND_TOOLS_AL_CHECK_FULL
+	#else
+		#define SOUND_TOOLS_AL_CHECK SOUND_TOOLS_AL_CHECK_DEFERRED
+	#endif
+#endif
+
+struct OpenAlCallSite
 {
-	auto ret = fn(args...);
-	auto error = alGetError();
+	const char* file;
+	int line;
+	const char* function;
+};
+
+// Queries alGetError after every call and throws with the failing call site.
+// While a batch is pending, an error can't be told apart from the batch's own,
+// it is left for the batch to report on Flush.
+struct OpenAlFullCheck
+{
+	static void AfterCall(const OpenAlCallSite& site);
+	static void Flush();
+};
+
+// Leaves errors pending in AL and queries them once per batch in Flush.
+// AL keeps the first error raised, the batch remembers where it started.
+// Errors belong to the current context, so batches are kept per context and
+// a flush on any thread reports the batch of every thread using that context.
+struct OpenAlDeferredCheck
+{
+	static void AfterCall(const OpenAlCallSite& site);
+	static void Flush();
+};
+
+struct OpenAlNoCheck
+{
+	static void AfterCall(const OpenAlCallSite&) {}
+	static void Flush() {}
+};
+
+#if SOUND_TOOLS_AL_CHECK == SOUND_TOOLS_AL_CHECK_FULL
+	using OpenAlCheckPolicy = OpenAlFullCheck;
+#elif SOUND_TOOLS_AL_CHECK == SOUND_TOOLS_AL_CHECK_DEFERRED
+	using OpenAlCheckPolicy = OpenAlDeferredCheck;
+#else
+	using OpenAlCheckPolicy = OpenAlNoCheck;
+#endif
 
-	if (error != AL_NO_ERROR)
-	{
-		auto message = alGetString(error);
-		throw std::runtime_error(message);
-	}
+// Batch APIs check once per batch even when single calls are fully checked
+#if SOUND_TOOLS_AL_CHECK == SOUND_TOOLS_AL_CHECK_NONE
+	using OpenAlBatchCheckPolicy = OpenAlNoCheck;
+#else
+	using OpenAlBatchCheckPolicy = OpenAlDeferredCheck;
+#endif
 
+template<typename Policy, typename Ret, typename... Args>
+Ret OpenAlInvoke(const OpenAlCallSite& site, Ret(*fn)(Args...), Args... args)
+{
+	auto ret = fn(args...);
+	Policy::AfterCall(site);
 	return ret;
 }
 
-template<typename... Args>
-void OpenAlCallVoid(void(*fn)(Args...), Args... args)
+template<typename Policy, typename... Args>
+void OpenAlInvokeVoid(const OpenAlCallSite& site, void(*fn)(Args...), Args... args)
 {
 	fn(args...);
-	auto error = alGetError();
+	Policy::AfterCall(site);
+}
+
+#define OpenAlCall(fn, ...) \
+	OpenAlInvoke<OpenAlCheckPolicy>(OpenAlCallSite{ __FILE__, __LINE__, #fn }, fn, __VA_ARGS__)
+
+#define OpenAlCallVoid(fn, ...) \
+	OpenAlInvokeVoid<OpenAlCheckPolicy>(OpenAlCallSite{ __FILE__, __LINE__, #fn }, fn, __VA_ARGS__)
 
-	if (error != AL_NO_ERROR)
-	{
-		auto message = alGetString(error);
-		throw std::runtime_error(message);
-	}
+// Always checked, for object creation where callers rely on the exception
+#define OpenAlCallStrict(fn, ...) \
+	OpenAlInvoke<OpenAlFullCheck>(OpenAlCallSite{ __FILE__, __LINE__, #fn }, fn, __VA_ARGS__)
+
+#define OpenAlCallVoidStrict(fn, ...) \
+	OpenAlInvokeVoid<OpenAlFullCheck>(OpenAlCallSite{ __FILE__, __LINE__, #fn }, fn, __VA_ARGS__)
+
+// Drops the batch of a context about to be destroyed
+void OpenAlForgetContext(ALCcontext* context);
+
+// Reports errors left pending by the active policy
+inline void OpenAlFlushErrors()
+{
+	OpenAlCheckPolicy::Flush();
 }
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "SampleConversion.h"
+#include "SineTable.h"
+
+#include "SoundTools/OscillatorBank.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#define SOUND_TOOLS_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace
+{
+	constexpr size_t blockSize = 256;
+	constexpr float noiseScale = 1.f / 2147483648.f;
+
+	struct Oscillator
+	{
+		Waveform waveform;
+		// Phase and increment in periods, phase stays in [0, 1)
+		float phase;
+		float increment;
+		float amplitude;
+		// Four independent xorshift generators, one per SIMD lane
+		uint32_t noise[4];
+	};
+
+	float Wrap(float phase)
+	{
+		return phase - static_cast<float>(static_cast<int>(phase));
+	}
+
+	uint32_t NextNoise(uint32_t& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	float ScalarSample(Oscillator& oscillator, float phase, size_t lane)
+	{
+		switch (oscillator.waveform)
+		{
+		case Waveform::Sine:
+		{
+			auto position = phase * sineTableSize;
+			auto index = static_cast<size_t>(position);
+			auto fraction = position - static_cast<float>(index);
+			return sineTable[index] + (sineTable[index + 1] - sineTable[index]) * fraction;
+		}
+		case Waveform::Square:
+			return phase < .5f ? 1.f : -1.f;
+		case Waveform::Saw:
+			return 2.f * phase - 1.f;
+		case Waveform::Triangle:
+			return 1.f - 4.f * std::abs(phase - .5f);
+		case Waveform::Noise:
+			return static_cast<float>(static_cast<int32_t>(NextNoise(oscillator.noise[lane]))) * noiseScale;
+		}
+
+		return 0;
+	}
+
+#ifdef SOUND_TOOLS_SSE2
+	__m128 WrapPhases(__m128 phases)
+	{
+		return _mm_sub_ps(phases, _mm_cvtepi32_ps(_mm_cvttps_epi32(phases)));
+	}
+
+	__m128 SineSamples(__m128 phases)
+	{
+		auto positions = _mm_mul_ps(phases, _mm_set1_ps(static_cast<float>(sineTableSize)));
+		auto indices = _mm_cvttps_epi32(positions);
+		auto fractions = _mm_sub_ps(positions, _mm_cvtepi32_ps(indices));
+
+		int32_t lanes[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), indices);
+
+		auto a = _mm_setr_ps(sineTable[lanes[0]], sineTable[lanes[1]], sineTable[lanes[2]], sineTable[lanes[3]]);
+		auto b = _mm_setr_ps(sineTable[lanes[0] + 1], sineTable[lanes[1] + 1], sineTable[lanes[2] + 1], sineTable[lanes[3] + 1]);
+
+		return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), fractions));
+	}
+
+	__m128 NoiseSamples(__m128i& state)
+	{
+		state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+		state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+		state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+		return _mm_mul_ps(_mm_cvtepi32_ps(state), _mm_set1_ps(noiseScale));
+	}
+
+	__m128 ShapeSamples(Waveform waveform, __m128 phases, __m128i& noise)
+	{
+		auto one = _mm_set1_ps(1.f);
+		auto half = _mm_set1_ps(.5f);
+
+		switch (waveform)
+		{
+		case Waveform::Sine:
+			return SineSamples(phases);
+		case Waveform::Square:
+			// 2 where phase < 0.5, then shifted to +-1
+			return _mm_sub_ps(_mm_and_ps(_mm_cmplt_ps(phases, half), _mm_set1_ps(2.f)), one);
+		case Waveform::Saw:
+			return _mm_sub_ps(_mm_add_ps(phases, phases), one);
+		case Waveform::Triangle:
+		{
+			auto distance = _mm_andnot_ps(_mm_set1_ps(-0.f), _mm_sub_ps(phases, half));
+			return _mm_sub_ps(one, _mm_mul_ps(distance, _mm_set1_ps(4.f)));
+		}
+		case Waveform::Noise:
+			return NoiseSamples(noise);
+		}
+
+		return _mm_setzero_ps();
+	}
+#endif
+
+	// Adds count samples of the oscillator to out
+	void AddOscillator(Oscillator& oscillator, float* out, size_t count)
+	{
+		size_t i = 0;
+
+#ifdef SOUND_TOOLS_SSE2
+		auto amplitude = _mm_set1_ps(oscillator.amplitude);
+		auto offsets = _mm_mul_ps(_mm_setr_ps(0, 1, 2, 3), _mm_set1_ps(oscillator.increment));
+		auto noise = _mm_loadu_si128(reinterpret_cast<const __m128i*>(oscillator.noise));
+
+		for (; i + 4 <= count; i += 4)
+		{
+			auto phases = WrapPhases(_mm_add_ps(_mm_set1_ps(oscillator.phase), offsets));
+			auto samples = ShapeSamples(oscillator.waveform, phases, noise);
+
+			_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(samples, amplitude)));
+			oscillator.phase = Wrap(oscillator.phase + 4 * oscillator.increment);
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(oscillator.noise), noise);
+#endif
+
+		for (; i < count; ++i)
+		{
+			out[i] += ScalarSample(oscillator, oscillator.phase, i % 4) * oscillator.amplitude;
+			oscillator.phase = Wrap(oscillator.phase + oscillator.increment);
+		}
+	}
+}
+
+class OscillatorBank::Impl
+{
+public:
+	float ToIncrement(float frequency) const
+	{
+		auto nyquist = static_cast<float>(sampleRate) * .5f;
+		return std::min(std::max(frequency, 0.f), nyquist) / static_cast<float>(sampleRate);
+	}
+
+	Oscillator& Get(size_t oscillator)
+	{
+		if (oscillator >= oscillators.size())
+		{
+			throw std::out_of_range("Invalid oscillator index");
+		}
+
+		return oscillators[oscillator];
+	}
+
+	size_t sampleRate;
+	std::vector<Oscillator> oscillators;
+	uint32_t noiseSeed;
+};
+
+OscillatorBank::OscillatorBank(size_t sampleRate) :
+	m_d(std::make_unique<Impl>())
+{
+	if (sampleRate == 0)
+	{
+		throw std::invalid_argument("Sample rate can't be zero");
+	}
+
+	m_d->sampleRate = sampleRate;
+	m_d->noiseSeed = 0x9E3779B9u;
+}
+
+OscillatorBank::~OscillatorBank() = default;
+
+size_t OscillatorBank::Add(Waveform waveform, float frequency, float amplitude)
+{
+	Oscillator oscillator;
+	oscillator.waveform = waveform;
+	oscillator.phase = 0;
+	oscillator.increment = m_d->ToIncrement(frequency);
+	oscillator.amplitude = amplitude;
+
+	// xorshift states must never be zero
+	for (auto& state : oscillator.noise)
+	{
+		m_d->noiseSeed = m_d->noiseSeed * 1664525u + 1013904223u;
+		state = m_d->noiseSeed | 1;
+	}
+
+	m_d->oscillators.push_back(oscillator);
+	return m_d->oscillators.size() - 1;
+}
+
+void OscillatorBank::SetFrequency(size_t oscillator, float frequency)
+{
+	m_d->Get(oscillator).increment = m_d->ToIncrement(frequency);
+}
+
+void OscillatorBank::SetAmplitude(size_t oscillator, float amplitude)
+{
+	m_d->Get(oscillator).amplitude = amplitude;
+}
+
+void OscillatorBank::Clear()
+{
+	m_d->oscillators.clear();
+}
+
+size_t OscillatorBank::GetSampleRate() const
+{
+	return m_d->sampleRate;
+}
+
+size_t OscillatorBank::GetOscillatorsCount() const
+{
+	return m_d->oscillators.size();
+}
+
+void OscillatorBank::Generate(float* out, size_t count)
+{
+	std::memset(out, 0, count * sizeof(float));
+
+	for (auto& oscillator : m_d->oscillators)
+	{
+		AddOscillator(oscillator, out, count);
+	}
+}
+
+void OscillatorBank::Generate(int16_t* out, size_t count)
+{
+	float block[blockSize];
+
+	for (size_t i = 0; i < count; i += blockSize)
+	{
+		auto n = std::min(blockSize, count - i);
+		Generate(block, n);
+		ConvertFloatToPcm16(block, out + i, n);
+	}
+}
+
+WaveBuffer OscillatorBank::MakeWaveBuffer(float duration, size_t bitsPerSample)
+{
+	if (bitsPerSample != 16 && bitsPerSample != 32)
+	{
+		throw std::invalid_argument("Only 16-bit PCM and 32-bit float output is supported");
+	}
+
+	auto samplesCount = static_cast<size_t>(std::max(duration, 0.f) * m_d->sampleRate);
+	auto dataSize = samplesCount * bitsPerSample / 8;
+	std::unique_ptr<uint8_t[]> data(new uint8_t[dataSize]);
+
+	if (bitsPerSample == 16)
+	{
+		Generate(reinterpret_cast<int16_t*>(data.get()), samplesCount);
+	}
+	else
+	{
+		Generate(reinterpret_cast<float*>(data.get()), samplesCount);
+	}
+
+	return WaveBuffer(
+		1, bitsPerSample, m_d->sampleRate,
+		std::move(data), dataSize,
+		bitsPerSample == 16 ? SampleEncoding::Pcm : SampleEncoding::Float);
+}
\ No newline at end of file
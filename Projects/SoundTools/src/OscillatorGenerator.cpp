@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "SoundTools/OscillatorGenerator.h"
+
+class OscillatorGenerator::Impl
+{
+public:
+	Impl(size_t sampleRate, float duration, size_t bitsPerSample) :
+		bank(sampleRate),
+		bitsPerSample(bitsPerSample),
+		samplesCount(static_cast<size_t>(std::max(duration, 0.f) * sampleRate)),
+		position(0)
+	{
+		if (bitsPerSample != 16 && bitsPerSample != 32)
+		{
+			throw std::invalid_argument("Only 16-bit PCM and 32-bit float output is supported");
+		}
+	}
+
+	OscillatorBank bank;
+	size_t bitsPerSample;
+	// Zero for endless generators
+	size_t samplesCount;
+	size_t position;
+};
+
+OscillatorGenerator::OscillatorGenerator(size_t sampleRate, float duration, size_t bitsPerSample) :
+	m_d(std::make_unique<Impl>(sampleRate, duration, bitsPerSample))
+{
+}
+
+OscillatorGenerator::~OscillatorGenerator() = default;
+
+OscillatorBank& OscillatorGenerator::GetBank()
+{
+	return m_d->bank;
+}
+
+SoundRenderFormat OscillatorGenerator::GetFormat() const
+{
+	return SoundRenderFormat
+	{
+		1,
+		m_d->bitsPerSample,
+		m_d->bank.GetSampleRate(),
+		m_d->bitsPerSample == 16 ? SampleEncoding::Pcm : SampleEncoding::Float
+	};
+}
+
+void OscillatorGenerator::Rewind()
+{
+	m_d->position = 0;
+}
+
+size_t OscillatorGenerator::Generate(void* data, size_t size)
+{
+	auto count = size / (m_d->bitsPerSample / 8);
+
+	if (m_d->samplesCount != 0)
+	{
+		count = std::min(count, m_d->samplesCount - m_d->position);
+		m_d->position += count;
+	}
+
+	if (m_d->bitsPerSample == 16)
+	{
+		m_d->bank.Generate(static_cast<int16_t*>(data), count);
+	}
+	else
+	{
+		m_d->bank.Generate(static_cast<float*>(data), count);
+	}
+
+	return count * m_d->bitsPerSample / 8;
+}
\ No newline at end of file
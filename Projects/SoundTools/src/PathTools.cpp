@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <climits>
+#endif
+
+#include "PathTools.h"
+
+#ifdef _WIN32
+
+std::string GetCanonicalPath(const char* path)
+{
+	char buffer[MAX_PATH];
+	auto length = GetFullPathNameA(path, MAX_PATH, buffer, nullptr);
+
+	std::string result = (length == 0 || length >= MAX_PATH) ? path : buffer;
+
+	// Paths on Windows are case-insensitive and accept both separators
+	std::replace(result.begin(), result.end(), '/', '\\');
+	std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+
+	return result;
+}
+
+#else
+
+std::string GetCanonicalPath(const char* path)
+{
+	char buffer[PATH_MAX];
+	return realpath(path, buffer) != nullptr ? buffer : path;
+}
+
+#endif
+
+std::string GetRelativeToFile(const char* baseFile, const char* path)
+{
+	std::string result(path);
+	bool absolute = !result.empty() && (result[0] == '/' || result[0] == '\\');
+
+#ifdef _WIN32
+	absolute = absolute || (result.size() > 1 && result[1] == ':');
+#endif
+
+	if (absolute)
+	{
+		return result;
+	}
+
+	std::string base(baseFile);
+	auto separator = base.find_last_of("/\\");
+
+	if (separator == std::string::npos)
+	{
+		return result;
+	}
+
+	return base.substr(0, separator + 1) + result;
+}
\ No newline at end of file
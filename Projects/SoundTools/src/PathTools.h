@@ -0,0 +1,9 @@
+#pragma once
+
+#include <string>
+
+// Absolute, normalized spelling of a path, usable as a key for the file it names
+std::string GetCanonicalPath(const char* path);
+
+// Resolves a path written relative to the directory of baseFile, absolute paths are kept
+std::string GetRelativeToFile(const char* baseFile, const char* path);
\ No newline at end of file
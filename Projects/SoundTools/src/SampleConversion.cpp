@@ -0,0 +1,410 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include "Adpcm.h"
+#include "SampleConversion.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#define SOUND_TOOLS_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace
+{
+	constexpr float pcm8Scale = 1.f / 128.f;
+	constexpr float pcm16Scale = 1.f / 32768.f;
+	constexpr float pcm32Scale = 1.f / 2147483648.f;
+
+	// Sign-extended 24-bit sample shifted into the high bytes of an int32
+	int32_t LoadPcm24(const uint8_t* src)
+	{
+		uint32_t word =
+			static_cast<uint32_t>(src[0]) << 8 |
+			static_cast<uint32_t>(src[1]) << 16 |
+			static_cast<uint32_t>(src[2]) << 24;
+		return static_cast<int32_t>(word);
+	}
+
+	int16_t FloatToPcm16(float sample)
+	{
+		sample = std::min(1.f, std::max(-1.f, sample));
+		return static_cast<int16_t>(sample * 32767.f);
+	}
+
+	constexpr int muLawBias = 0x84;
+	constexpr int muLawClip = 32635;
+
+	std::array<int16_t, 256> MakeMuLawTable()
+	{
+		std::array<int16_t, 256> table;
+
+		for (int i = 0; i < 256; ++i)
+		{
+			auto value = ~i & 0xFF;
+			auto magnitude = (((value & 0x0F) << 3) + muLawBias) << ((value & 0x70) >> 4);
+			table[i] = static_cast<int16_t>((value & 0x80) ? muLawBias - magnitude : magnitude - muLawBias);
+		}
+
+		return table;
+	}
+
+	uint8_t Pcm16ToMuLaw(int16_t sample)
+	{
+		int sign = sample < 0 ? 0x80 : 0;
+		int magnitude = std::min(sign ? -static_cast<int>(sample) : static_cast<int>(sample), muLawClip) + muLawBias;
+
+		// Segment is the position of the highest set bit above the bias
+		int exponent = 7;
+		for (int mask = 0x4000; (magnitude & mask) == 0 && exponent > 0; mask >>= 1)
+		{
+			--exponent;
+		}
+
+		int mantissa = (magnitude >> (exponent + 3)) & 0x0F;
+		return static_cast<uint8_t>(~(sign | (exponent << 4) | mantissa));
+	}
+
+#ifdef SOUND_TOOLS_SSE2
+	// Reads one byte past the fourth sample, callers keep a scalar tail
+	__m128i LoadPcm24x4(const uint8_t* src)
+	{
+		uint32_t words[4];
+		std::memcpy(&words[0], src + 0, 4);
+		std::memcpy(&words[1], src + 3, 4);
+		std::memcpy(&words[2], src + 6, 4);
+		std::memcpy(&words[3], src + 9, 4);
+
+		auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words));
+		return _mm_slli_epi32(v, 8);
+	}
+#endif
+}
+
+void ConvertPcm8ToFloat(const uint8_t* src, float* dst, size_t count)
+{
+	size_t i = 0;
+
+#ifdef SOUND_TOOLS_SSE2
+	auto scale = _mm_set1_ps(pcm8Scale);
+	auto zero = _mm_setzero_si128();
+	auto bias = _mm_set1_epi16(128);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		// Unsigned bytes to signed words, then sign-extended to dwords
+		auto bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+		auto words = _mm_sub_epi16(_mm_unpacklo_epi8(bytes, zero), bias);
+		auto low = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+		auto high = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+		_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		dst[i] = static_cast<float>(static_cast<int>(src[i]) - 128) * pcm8Scale;
+	}
+}
+
+void ConvertPcm16ToFloat(const int16_t* src, float* dst, size_t count)
+{
+	size_t i = 0;
+
+#ifdef SOUND_TOOLS_SSE2
+	auto scale = _mm_set1_ps(pcm16Scale);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		auto words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		auto low = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+		auto high = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+		_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		dst[i] = static_cast<float>(src[i]) * pcm16Scale;
+	}
+}
+
+void ConvertPcm24ToFloat(const uint8_t* src, float* dst, size_t count)
+{
+	size_t i = 0;
+
+#ifdef SOUND_TOOLS_SSE2
+	auto scale = _mm_set1_ps(pcm32Scale);
+
+	for (; i + 5 <= count; i += 4)
+	{
+		auto v = _mm_cvtepi32_ps(LoadPcm24x4(src + i * 3));
+		_mm_storeu_ps(dst + i, _mm_mul_ps(v, scale));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		dst[i] = static_cast<float>(LoadPcm24(src + i * 3)) * pcm32Scale;
+	}
+}
+
+void ConvertPcm32ToFloat(const int32_t* src, float* dst, size_t count)
+{
+	size_t i = 0;
+
+#ifdef SOUND_TOOLS_SSE2
+	auto scale = _mm_set1_ps(pcm32Scale);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		auto v = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+		_mm_storeu_ps(dst + i, _mm_mul_ps(v, scale));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		dst[i] = static_cast<float>(src[i]) * pcm32Scale;
+	}
+}
+
+void ConvertDoubleToFloat(const double* src, float* dst, size_t count)
+{
+	size_t i = 0;
+
+#ifdef SOUND_TOOLS_SSE2
+	for (; i + 4 <= count; i += 4)
+	{
+		auto low = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+		auto high = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+		_mm_storeu_ps(dst + i, _mm_movelh_ps(low, high));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		dst[i] = static_cast<float>(src[i]);
+	}
+}
+
+void ConvertFloatToPcm16(const float* src, int16_t* dst, size_t count)
+{
+	size_t i = 0;
+
+#ifdef SOUND_TOOLS_SSE2
+	auto scale = _mm_set1_ps(32767.f);
+	auto minValue = _mm_set1_ps(-1.f);
+	auto maxValue = _mm_set1_ps(1.f);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		auto low = _mm_loadu_ps(src + i);
+		auto high = _mm_loadu_ps(src + i + 4);
+		low = _mm_mul_ps(_mm_min_ps(_mm_max_ps(low, minValue), maxValue), scale);
+		high = _mm_mul_ps(_mm_min_ps(_mm_max_ps(high, minValue), maxValue), scale);
+
+		auto packed = _mm_packs_epi32(_mm_cvttps_epi32(low), _mm_cvttps_epi32(high));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		dst[i] = FloatToPcm16(src[i]);
+	}
+}
+
+void ConvertPcm24ToPcm16(const uint8_t* src, int16_t* dst, size_t count)
+{
+	size_t i = 0;
+
+#ifdef SOUND_TOOLS_SSE2
+	for (; i + 9 <= count; i += 8)
+	{
+		auto low = _mm_srai_epi32(LoadPcm24x4(src + i * 3), 16);
+		auto high = _mm_srai_epi32(LoadPcm24x4(src + (i + 4) * 3), 16);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(low, high));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		dst[i] = static_cast<int16_t>(LoadPcm24(src + i * 3) >> 16);
+	}
+}
+
+void ConvertPcm32ToPcm16(const int32_t* src, int16_t* dst, size_t count)
+{
+	size_t i = 0;
+
+#ifdef SOUND_TOOLS_SSE2
+	for (; i + 8 <= count; i += 8)
+	{
+		auto low = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), 16);
+		auto high = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)), 16);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(low, high));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		dst[i] = static_cast<int16_t>(src[i] >> 16);
+	}
+}
+
+void ConvertMuLawToPcm16(const uint8_t* src, int16_t* dst, size_t count)
+{
+	static const auto table = MakeMuLawTable();
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = table[src[i]];
+	}
+}
+
+void ConvertPcm16ToMuLaw(const int16_t* src, uint8_t* dst, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = Pcm16ToMuLaw(src[i]);
+	}
+}
+
+void ConvertSamples(
+	SampleEncoding srcEncoding, size_t srcBitsPerSample, const void* src, size_t srcSize,
+	SampleEncoding dstEncoding, size_t dstBitsPerSample, std::vector<uint8_t>& dst)
+{
+	if (IsAdpcm(srcEncoding) || IsAdpcm(dstEncoding))
+	{
+		throw std::invalid_argument("Unsupported sample conversion");
+	}
+
+	auto count = srcSize / (srcBitsPerSample / 8);
+	auto bytes = static_cast<const uint8_t*>(src);
+	dst.resize(count * dstBitsPerSample / 8);
+
+	if (dstEncoding == SampleEncoding::Float && dstBitsPerSample == 32)
+	{
+		auto out = reinterpret_cast<float*>(dst.data());
+
+		if (srcEncoding == SampleEncoding::Pcm && srcBitsPerSample == 8)
+		{
+			return ConvertPcm8ToFloat(bytes, out, count);
+		}
+
+		if (srcEncoding == SampleEncoding::Pcm && srcBitsPerSample == 16)
+		{
+			return ConvertPcm16ToFloat(reinterpret_cast<const int16_t*>(bytes), out, count);
+		}
+
+		if (srcEncoding == SampleEncoding::Pcm && srcBitsPerSample == 24)
+		{
+			return ConvertPcm24ToFloat(bytes, out, count);
+		}
+
+		if (srcEncoding == SampleEncoding::Pcm && srcBitsPerSample == 32)
+		{
+			return ConvertPcm32ToFloat(reinterpret_cast<const int32_t*>(bytes), out, count);
+		}
+
+		if (srcEncoding == SampleEncoding::Float && srcBitsPerSample == 64)
+		{
+			return ConvertDoubleToFloat(reinterpret_cast<const double*>(bytes), out, count);
+		}
+
+		if (srcEncoding == SampleEncoding::Float && srcBitsPerSample == 32)
+		{
+			std::memcpy(out, bytes, dst.size());
+			return;
+		}
+
+		if (srcEncoding == SampleEncoding::MuLaw)
+		{
+			int16_t block[1024];
+
+			for (size_t i = 0; i < count; i += 1024)
+			{
+				auto n = std::min<size_t>(1024, count - i);
+				ConvertMuLawToPcm16(bytes + i, block, n);
+				ConvertPcm16ToFloat(block, out + i, n);
+			}
+
+			return;
+		}
+	}
+	else if (dstEncoding == SampleEncoding::Pcm && dstBitsPerSample == 16)
+	{
+		auto out = reinterpret_cast<int16_t*>(dst.data());
+
+		if (srcEncoding == SampleEncoding::Pcm && srcBitsPerSample == 16)
+		{
+			std::memcpy(out, bytes, dst.size());
+			return;
+		}
+
+		if (srcEncoding == SampleEncoding::MuLaw)
+		{
+			return ConvertMuLawToPcm16(bytes, out, count);
+		}
+
+		if (srcEncoding == SampleEncoding::Pcm && srcBitsPerSample == 24)
+		{
+			return ConvertPcm24ToPcm16(bytes, out, count);
+		}
+
+		if (srcEncoding == SampleEncoding::Pcm && srcBitsPerSample == 32)
+		{
+			return ConvertPcm32ToPcm16(reinterpret_cast<const int32_t*>(bytes), out, count);
+		}
+
+		if (srcEncoding == SampleEncoding::Float && srcBitsPerSample == 32)
+		{
+			return ConvertFloatToPcm16(reinterpret_cast<const float*>(bytes), out, count);
+		}
+
+		if (srcEncoding == SampleEncoding::Float && srcBitsPerSample == 64)
+		{
+			// Go through float in cache-sized pieces to keep the temporary small
+			float block[1024];
+			auto doubles = reinterpret_cast<const double*>(bytes);
+
+			for (size_t i = 0; i < count; i += 1024)
+			{
+				auto n = std::min<size_t>(1024, count - i);
+				ConvertDoubleToFloat(doubles + i, block, n);
+				ConvertFloatToPcm16(block, out + i, n);
+			}
+
+			return;
+		}
+	}
+	else if (dstEncoding == SampleEncoding::MuLaw)
+	{
+		if (srcEncoding == SampleEncoding::Pcm && srcBitsPerSample == 16)
+		{
+			return ConvertPcm16ToMuLaw(reinterpret_cast<const int16_t*>(bytes), dst.data(), count);
+		}
+	}
+
+	throw std::invalid_argument("Unsupported sample conversion");
+}
+
+uint64_t GetFramesCount(
+	SampleEncoding encoding, size_t channels, size_t bitsPerSample, size_t blockAlign,
+	uint64_t size)
+{
+	if (IsAdpcm(encoding))
+	{
+		auto framesPerBlock = GetAdpcmFramesPerBlock(encoding, channels, blockAlign);
+		return framesPerBlock == 0 ? 0 : size / blockAlign * framesPerBlock;
+	}
+
+	auto frameSize = channels * bitsPerSample / 8;
+	return frameSize == 0 ? 0 : size / frameSize;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SoundTools/SampleEncoding.h"
+
+void ConvertPcm8ToFloat(const uint8_t* src, float* dst, size_t count);
+void ConvertPcm16ToFloat(const int16_t* src, float* dst, size_t count);
+void ConvertPcm24ToFloat(const uint8_t* src, float* dst, size_t count);
+void ConvertPcm32ToFloat(const int32_t* src, float* dst, size_t count);
+void ConvertDoubleToFloat(const double* src, float* dst, size_t count);
+void ConvertFloatToPcm16(const float* src, int16_t* dst, size_t count);
+void ConvertPcm24ToPcm16(const uint8_t* src, int16_t* dst, size_t count);
+void ConvertPcm32ToPcm16(const int32_t* src, int16_t* dst, size_t count);
+void ConvertMuLawToPcm16(const uint8_t* src, int16_t* dst, size_t count);
+void ConvertPcm16ToMuLaw(const int16_t* src, uint8_t* dst, size_t count);
+
+// Converts interleaved samples between the encodings supported by the kernels above.
+// ADPCM needs the block layout and goes through DecodeAdpcm and EncodeAdpcm instead.
+void ConvertSamples(
+	SampleEncoding srcEncoding, size_t srcBitsPerSample, const void* src, size_t srcSize,
+	SampleEncoding dstEncoding, size_t dstBitsPerSample, std::vector<uint8_t>& dst);
+
+// Whole frames in size bytes of samples, ADPCM counts whole blocks of blockAlign bytes
+uint64_t GetFramesCount(
+	SampleEncoding encoding, size_t channels, size_t bitsPerSample, size_t blockAlign,
+	uint64_t size);
\ No newline at end of file
@@ -0,0 +1,769 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "MpscQueue.h"
+#include "PathTools.h"
+#include "SampleConversion.h"
+
+#include "SoundTools/Sequencer.h"
+#include "SoundTools/SoundMixer.h"
+
+namespace
+{
+	constexpr size_t renderBlockFrames = 1024;
+	// Linear ramps that keep notes from clicking when they start and end
+	constexpr float attackSeconds = 0.005f;
+	constexpr float releaseSeconds = 0.02f;
+
+	enum class EventType
+	{
+		NoteOn,
+		NoteOff,
+		PlayClip,
+		SetTrackGain,
+		SetTrackPitch
+	};
+
+	struct Event
+	{
+		uint64_t frame;
+		EventType type;
+		size_t track;
+		uint8_t key;
+		Waveform waveform;
+		// Velocity, clip gain or the new track parameter
+		float value;
+		float pitch;
+		std::shared_ptr<const SoundMixerClip> clip;
+	};
+
+	struct Track
+	{
+		float gain;
+		float pitch;
+	};
+
+	struct NoteVoice
+	{
+		std::unique_ptr<OscillatorBank> bank;
+		size_t track;
+		uint8_t key;
+		float frequency;
+		float velocity;
+		float level;
+		bool active;
+		bool releasing;
+		// Note on counter value, the oldest voice is stolen when all of them are busy
+		uint64_t started;
+	};
+
+	struct ClipVoice
+	{
+		SoundMixerVoice voice;
+		size_t track;
+		float gain;
+		float pitch;
+	};
+
+	uint64_t ToFrame(double time, size_t sampleRate)
+	{
+		return static_cast<uint64_t>(std::llround(std::max(time, 0.) * sampleRate));
+	}
+
+	float KeyToFrequency(uint8_t key)
+	{
+		return 440.f * std::pow(2.f, (static_cast<float>(key) - 69.f) / 12.f);
+	}
+
+	template<typename T>
+	bool ParseNumber(const std::string& text, T& value)
+	{
+		std::istringstream stream(text);
+		return (stream >> value) && (stream >> std::ws).eof();
+	}
+
+	bool ParseKey(const std::string& text, uint8_t& key)
+	{
+		int value;
+
+		if (!ParseNumber(text, value) || value < 0 || value > 127)
+		{
+			return false;
+		}
+
+		key = static_cast<uint8_t>(value);
+		return true;
+	}
+
+	bool ParseWaveform(const std::string& text, Waveform& waveform)
+	{
+		static const std::map<std::string, Waveform> names =
+		{
+			{ "sine", Waveform::Sine },
+			{ "square", Waveform::Square },
+			{ "saw", Waveform::Saw },
+			{ "triangle", Waveform::Triangle },
+			{ "noise", Waveform::Noise }
+		};
+
+		auto found = names.find(text);
+
+		if (found == names.end())
+		{
+			return false;
+		}
+
+		waveform = found->second;
+		return true;
+	}
+
+	// Turns score lines into events, see Sequencer::LoadScore for the syntax
+	class ScoreReader
+	{
+	public:
+		ScoreReader(const char* filename, double offset, size_t sampleRate) :
+			m_filename(filename),
+			m_offset(offset),
+			m_secondsPerBeat(1),
+			m_sampleRate(sampleRate)
+		{}
+
+		// Returns false when the line is malformed
+		bool ReadLine(const std::vector<std::string>& words, std::vector<Event>& events)
+		{
+			if (words[0] == "tempo")
+			{
+				double bpm;
+
+				if (words.size() != 2 || !ParseNumber(words[1], bpm) || bpm <= 0)
+				{
+					return false;
+				}
+
+				m_secondsPerBeat = 60 / bpm;
+				return true;
+			}
+
+			if (words[0] == "clip")
+			{
+				if (words.size() != 3)
+				{
+					return false;
+				}
+
+				WaveBuffer wave(GetRelativeToFile(m_filename, words[2].c_str()).c_str());
+				m_clips[words[1]] = std::make_shared<const SoundMixerClip>(wave);
+				return true;
+			}
+
+			double time;
+			size_t track;
+
+			if (words.size() < 3 ||
+				!ParseNumber(words[0], time) || time < 0 ||
+				!ParseNumber(words[2], track) || track >= sequencerTracksCount)
+			{
+				return false;
+			}
+
+			auto& command = words[1];
+			auto argsCount = words.size() - 3;
+
+			Event event = {};
+			event.frame = ToFrame(m_offset + time * m_secondsPerBeat, m_sampleRate);
+			event.track = track;
+			event.value = 1;
+			event.pitch = 1;
+
+			if (command == "on" || command == "note")
+			{
+				// Note length comes between the key and the optional arguments
+				size_t optional = command == "note" ? 5 : 4;
+
+				if (argsCount < optional - 3 || argsCount > optional - 1 ||
+					!ParseKey(words[3], event.key) ||
+					(words.size() > optional && !ParseNumber(words[optional], event.value)) ||
+					(words.size() > optional + 1 && !ParseWaveform(words[optional + 1], event.waveform)))
+				{
+					return false;
+				}
+
+				event.type = EventType::NoteOn;
+				events.push_back(event);
+
+				if (command == "note")
+				{
+					double length;
+
+					if (!ParseNumber(words[4], length) || length < 0)
+					{
+						return false;
+					}
+
+					event.type = EventType::NoteOff;
+					event.frame = ToFrame(m_offset + (time + length) * m_secondsPerBeat, m_sampleRate);
+					events.push_back(event);
+				}
+
+				return true;
+			}
+
+			if (command == "off")
+			{
+				if (argsCount != 1 || !ParseKey(words[3], event.key))
+				{
+					return false;
+				}
+
+				event.type = EventType::NoteOff;
+				events.push_back(event);
+				return true;
+			}
+
+			if (command == "play")
+			{
+				if (argsCount < 1 || argsCount > 3 ||
+					(argsCount > 1 && !ParseNumber(words[4], event.value)) ||
+					(argsCount > 2 && !ParseNumber(words[5], event.pitch)))
+				{
+					return false;
+				}
+
+				auto clip = m_clips.find(words[3]);
+
+				if (clip == m_clips.end())
+				{
+					return false;
+				}
+
+				event.type = EventType::PlayClip;
+				event.clip = clip->second;
+				events.push_back(event);
+				return true;
+			}
+
+			if (command == "gain" || command == "pitch")
+			{
+				if (argsCount != 1 || !ParseNumber(words[3], event.value))
+				{
+					return false;
+				}
+
+				event.type = command == "gain" ? EventType::SetTrackGain : EventType::SetTrackPitch;
+				events.push_back(event);
+				return true;
+			}
+
+			return false;
+		}
+
+	private:
+		const char* m_filename;
+		double m_offset;
+		double m_secondsPerBeat;
+		size_t m_sampleRate;
+		std::map<std::string, std::shared_ptr<const SoundMixerClip>> m_clips;
+	};
+}
+
+class Sequencer::Impl
+{
+public:
+	Impl(size_t channelsCount, size_t sampleRate, size_t bitsPerSample, bool endless, size_t polyphony) :
+		channelsCount(channelsCount),
+		sampleRate(sampleRate),
+		bitsPerSample(bitsPerSample),
+		endless(endless),
+		mixer(channelsCount, sampleRate, polyphony),
+		notes(polyphony),
+		cursor(0),
+		position(0),
+		clock(0),
+		notesStarted(0),
+		attackStep(1.f / (attackSeconds * sampleRate)),
+		releaseStep(1.f / (releaseSeconds * sampleRate)),
+		noteBlock(renderBlockFrames),
+		renderBlock(renderBlockFrames * channelsCount)
+	{
+		for (auto& note : notes)
+		{
+			note.bank = std::make_unique<OscillatorBank>(sampleRate);
+			note.active = false;
+		}
+
+		clipVoices.reserve(polyphony);
+		ResetTracks();
+	}
+
+	void Schedule(Event&& event)
+	{
+		if (event.track >= sequencerTracksCount)
+		{
+			throw std::out_of_range("Invalid track index");
+		}
+
+		incoming.Push(std::move(event));
+	}
+
+	void ReceiveEvents()
+	{
+		Event event;
+
+		while (incoming.Pop(event))
+		{
+			// Late events play right away, keeping the played part of the score sorted for replays
+			event.frame = std::max(event.frame, position);
+
+			// Events with equal times keep the order they were scheduled in
+			auto at = std::upper_bound(
+				events.begin() + cursor, events.end(), event.frame,
+				[](uint64_t frame, const Event& scheduled) { return frame < scheduled.frame; });
+
+			events.insert(at, std::move(event));
+		}
+	}
+
+	void ResetTracks()
+	{
+		for (auto& track : tracks)
+		{
+			track.gain = 1;
+			track.pitch = 1;
+		}
+	}
+
+	NoteVoice& AllocateNote()
+	{
+		auto found = std::find_if(notes.begin(), notes.end(), [](const NoteVoice& note) { return !note.active; });
+
+		if (found != notes.end())
+		{
+			return *found;
+		}
+
+		return *std::min_element(notes.begin(), notes.end(), [](const NoteVoice& a, const NoteVoice& b)
+		{
+			return a.started < b.started;
+		});
+	}
+
+	void ApplyEvent(const Event& event)
+	{
+		auto& track = tracks[event.track];
+
+		switch (event.type)
+		{
+		case EventType::NoteOn:
+		{
+			auto& note = AllocateNote();
+			note.track = event.track;
+			note.key = event.key;
+			note.frequency = KeyToFrequency(event.key);
+			note.velocity = event.value;
+			note.level = 0;
+			note.active = true;
+			note.releasing = false;
+			note.started = notesStarted++;
+			note.bank->Clear();
+			note.bank->Add(event.waveform, note.frequency * track.pitch);
+			break;
+		}
+		case EventType::NoteOff:
+			for (auto& note : notes)
+			{
+				if (note.active && note.track == event.track && note.key == event.key)
+				{
+					note.releasing = true;
+				}
+			}
+			break;
+		case EventType::PlayClip:
+		{
+			auto voice = mixer.Play(event.clip, event.value * track.gain, event.pitch * track.pitch);
+			ForgetFinishedClips();
+			clipVoices.push_back(ClipVoice{ voice, event.track, event.value, event.pitch });
+			break;
+		}
+		case EventType::SetTrackGain:
+			track.gain = event.value;
+			ForgetFinishedClips();
+
+			for (auto& clip : clipVoices)
+			{
+				if (clip.track == event.track)
+				{
+					mixer.SetGain(clip.voice, clip.gain * track.gain);
+				}
+			}
+			break;
+		case EventType::SetTrackPitch:
+			track.pitch = event.value;
+			ForgetFinishedClips();
+
+			for (auto& note : notes)
+			{
+				if (note.active && note.track == event.track)
+				{
+					note.bank->SetFrequency(0, note.frequency * track.pitch);
+				}
+			}
+
+			for (auto& clip : clipVoices)
+			{
+				if (clip.track == event.track)
+				{
+					mixer.SetPitch(clip.voice, clip.pitch * track.pitch);
+				}
+			}
+			break;
+		}
+	}
+
+	void ForgetFinishedClips()
+	{
+		clipVoices.erase(
+			std::remove_if(clipVoices.begin(), clipVoices.end(), [this](const ClipVoice& clip)
+			{
+				return !mixer.IsPlaying(clip.voice);
+			}),
+			clipVoices.end());
+	}
+
+	// Adds count frames of every sounding note to out, count is at most renderBlockFrames
+	void RenderNotes(float* out, size_t count)
+	{
+		for (auto& note : notes)
+		{
+			if (!note.active)
+			{
+				continue;
+			}
+
+			note.bank->Generate(noteBlock.data(), count);
+			auto gain = note.velocity * tracks[note.track].gain;
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (note.releasing)
+				{
+					note.level -= releaseStep;
+
+					if (note.level <= 0)
+					{
+						note.active = false;
+						break;
+					}
+				}
+				else if (note.level < 1)
+				{
+					note.level = std::min(note.level + attackStep, 1.f);
+				}
+
+				auto sample = noteBlock[i] * note.level * gain;
+
+				for (size_t channel = 0; channel < channelsCount; ++channel)
+				{
+					out[i * channelsCount + channel] += sample;
+				}
+			}
+		}
+	}
+
+	// Renders framesCount frames, at most renderBlockFrames, applying each event on its frame
+	void Render(float* out, size_t framesCount)
+	{
+		size_t done = 0;
+
+		while (done < framesCount)
+		{
+			while (cursor < events.size() && events[cursor].frame <= position)
+			{
+				ApplyEvent(events[cursor++]);
+			}
+
+			auto count = framesCount - done;
+
+			if (cursor < events.size())
+			{
+				count = static_cast<size_t>(std::min<uint64_t>(count, events[cursor].frame - position));
+			}
+
+			auto dst = out + done * channelsCount;
+			mixer.Mix(dst, count);
+			RenderNotes(dst, count);
+
+			position += count;
+			done += count;
+		}
+
+		if (endless)
+		{
+			for (size_t i = 0; i < cursor; ++i)
+			{
+				events[i].clip.reset();
+			}
+
+			events.erase(events.begin(), events.begin() + cursor);
+			cursor = 0;
+		}
+
+		clock.store(position, std::memory_order_relaxed);
+	}
+
+	bool IsFinished() const
+	{
+		if (endless || cursor < events.size() || mixer.GetStats().activeVoices != 0)
+		{
+			return false;
+		}
+
+		return std::none_of(notes.begin(), notes.end(), [](const NoteVoice& note) { return note.active; });
+	}
+
+	size_t channelsCount;
+	size_t sampleRate;
+	size_t bitsPerSample;
+	bool endless;
+	SoundMixer mixer;
+	std::vector<NoteVoice> notes;
+	std::vector<ClipVoice> clipVoices;
+	Track tracks[sequencerTracksCount];
+	// Scheduled from any thread, moved into events by the rendering thread
+	MpscQueue<Event> incoming;
+	// Sorted by frame, the ones before the cursor have been applied
+	std::vector<Event> events;
+	size_t cursor;
+	uint64_t position;
+	// Copy of position for other threads
+	std::atomic<uint64_t> clock;
+	uint64_t notesStarted;
+	float attackStep;
+	float releaseStep;
+	std::vector<float> noteBlock;
+	std::vector<float> renderBlock;
+};
+
+Sequencer::Sequencer(
+	size_t channelsCount, size_t sampleRate,
+	size_t bitsPerSample,
+	bool endless,
+	size_t polyphony)
+{
+	if (bitsPerSample != 16 && bitsPerSample != 32)
+	{
+		throw std::invalid_argument("Only 16-bit PCM and 32-bit float output is supported");
+	}
+
+	if (polyphony == 0)
+	{
+		throw std::invalid_argument("Polyphony can't be zero");
+	}
+
+	m_d = std::make_unique<Impl>(channelsCount, sampleRate, bitsPerSample, endless, polyphony);
+}
+
+Sequencer::~Sequencer() = default;
+
+void Sequencer::NoteOn(double time, size_t track, uint8_t key, float velocity, Waveform waveform)
+{
+	Event event = {};
+	event.frame = ToFrame(time, m_d->sampleRate);
+	event.type = EventType::NoteOn;
+	event.track = track;
+	event.key = key;
+	event.waveform = waveform;
+	event.value = velocity;
+	m_d->Schedule(std::move(event));
+}
+
+void Sequencer::NoteOff(double time, size_t track, uint8_t key)
+{
+	Event event = {};
+	event.frame = ToFrame(time, m_d->sampleRate);
+	event.type = EventType::NoteOff;
+	event.track = track;
+	event.key = key;
+	m_d->Schedule(std::move(event));
+}
+
+void Sequencer::PlayClip(double time, size_t track, std::shared_ptr<const SoundMixerClip> clip, float gain, float pitch)
+{
+	if (clip == nullptr)
+	{
+		throw std::invalid_argument("Clip can't be null");
+	}
+
+	Event event = {};
+	event.frame = ToFrame(time, m_d->sampleRate);
+	event.type = EventType::PlayClip;
+	event.track = track;
+	event.value = gain;
+	event.pitch = pitch;
+	event.clip = std::move(clip);
+	m_d->Schedule(std::move(event));
+}
+
+void Sequencer::SetTrackGain(double time, size_t track, float gain)
+{
+	Event event = {};
+	event.frame = ToFrame(time, m_d->sampleRate);
+	event.type = EventType::SetTrackGain;
+	event.track = track;
+	event.value = gain;
+	m_d->Schedule(std::move(event));
+}
+
+void Sequencer::SetTrackPitch(double time, size_t track, float pitch)
+{
+	Event event = {};
+	event.frame = ToFrame(time, m_d->sampleRate);
+	event.type = EventType::SetTrackPitch;
+	event.track = track;
+	event.value = pitch;
+	m_d->Schedule(std::move(event));
+}
+
+void Sequencer::LoadScore(const char* filename, double time)
+{
+	std::ifstream file(filename);
+
+	if (!file.is_open())
+	{
+		throw std::invalid_argument("Failed to open the file");
+	}
+
+	ScoreReader reader(filename, time, m_d->sampleRate);
+	std::vector<Event> events;
+	std::string line;
+
+	for (size_t lineNumber = 1; std::getline(file, line); ++lineNumber)
+	{
+		line.erase(std::min(line.find('#'), line.size()));
+
+		std::istringstream stream(line);
+		std::vector<std::string> words(
+			(std::istream_iterator<std::string>(stream)),
+			std::istream_iterator<std::string>());
+
+		if (!words.empty() && !reader.ReadLine(words, events))
+		{
+			throw std::runtime_error("Invalid score line " + std::to_string(lineNumber));
+		}
+	}
+
+	// Nothing is scheduled from a score that fails to load
+	for (auto& event : events)
+	{
+		m_d->Schedule(std::move(event));
+	}
+}
+
+double Sequencer::GetTime() const
+{
+	return static_cast<double>(m_d->clock.load(std::memory_order_relaxed)) / m_d->sampleRate;
+}
+
+SoundRenderFormat Sequencer::GetFormat() const
+{
+	return SoundRenderFormat
+	{
+		m_d->channelsCount,
+		m_d->bitsPerSample,
+		m_d->sampleRate,
+		m_d->bitsPerSample == 16 ? SampleEncoding::Pcm : SampleEncoding::Float
+	};
+}
+
+void Sequencer::Rewind()
+{
+	for (auto& clip : m_d->clipVoices)
+	{
+		m_d->mixer.Stop(clip.voice);
+	}
+
+	for (auto& note : m_d->notes)
+	{
+		note.active = false;
+	}
+
+	m_d->clipVoices.clear();
+	m_d->ResetTracks();
+	m_d->cursor = 0;
+	m_d->position = 0;
+	m_d->clock.store(0, std::memory_order_relaxed);
+}
+
+size_t Sequencer::Generate(void* data, size_t size)
+{
+	m_d->ReceiveEvents();
+
+	auto frameSize = m_d->channelsCount * m_d->bitsPerSample / 8;
+	auto framesCount = size / frameSize;
+	size_t done = 0;
+
+	while (done < framesCount && !m_d->IsFinished())
+	{
+		auto count = std::min(framesCount - done, renderBlockFrames);
+		auto samplesOffset = done * m_d->channelsCount;
+
+		if (m_d->bitsPerSample == 32)
+		{
+			m_d->Render(static_cast<float*>(data) + samplesOffset, count);
+		}
+		else
+		{
+			m_d->Render(m_d->renderBlock.data(), count);
+			ConvertFloatToPcm16(
+				m_d->renderBlock.data(),
+				static_cast<int16_t*>(data) + samplesOffset,
+				count * m_d->channelsCount);
+		}
+
+		done += count;
+	}
+
+	return done * frameSize;
+}
+
+WaveBuffer Sequencer::MakeWaveBuffer()
+{
+	if (m_d->endless)
+	{
+		throw std::runtime_error("Endless sequencer can't be rendered into a buffer");
+	}
+
+	auto blockSize = renderBlockFrames * m_d->channelsCount * m_d->bitsPerSample / 8;
+	std::vector<uint8_t> samples;
+
+	for (;;)
+	{
+		auto offset = samples.size();
+		samples.resize(offset + blockSize);
+
+		auto written = Generate(samples.data() + offset, blockSize);
+		samples.resize(offset + written);
+
+		if (written == 0)
+		{
+			break;
+		}
+	}
+
+	std::unique_ptr<uint8_t[]> data(new uint8_t[samples.size()]);
+	std::memcpy(data.get(), samples.data(), samples.size());
+
+	auto format = GetFormat();
+	return WaveBuffer(
+		format.channelsCount, format.bitsPerSample, format.sampleRate,
+		std::move(data), samples.size(),
+		format.encoding);
+}
\ No newline at end of file
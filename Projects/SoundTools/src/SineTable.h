@@ -0,0 +1,29 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+constexpr size_t sineTableSize = 1024;
+constexpr double sineTablePi = 3.14159265358979323846;
+
+// Taylor series of sin around zero, accurate to double precision on [-pi, pi]
+constexpr double ConstSinSeries(double x2, double term, double sum, int n)
+{
+	return n > 40 ? sum : ConstSinSeries(x2, -term * x2 / (n * (n + 1)), sum + term, n + 2);
+}
+
+constexpr double ConstSin(double x)
+{
+	return ConstSinSeries(x * x, x, 0, 2);
+}
+
+// sin(2 pi i / size) for i in [0, size], sin(x) = -sin(x - pi) keeps the argument in range
+template<size_t... indices>
+constexpr std::array<float, sizeof...(indices)> MakeSineTable(std::index_sequence<indices...>)
+{
+	return {{ static_cast<float>(-ConstSin(2 * sineTablePi * indices / sineTableSize - sineTablePi))... }};
+}
+
+// One guard element past the period so interpolation never wraps
+constexpr auto sineTable = MakeSineTable(std::make_index_sequence<sineTableSize + 1>());
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Values stored contiguously and addressed by index and generation.
+// Erasing bumps the slot's generation, so a stale key costs one compare to reject.
+// Freed slots are chained through the free list and reused first.
+template<typename T>
+class SlotMap
+{
+public:
+	static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+	struct Key
+	{
+		uint32_t index;
+		uint32_t generation;
+	};
+
+	SlotMap() :
+		m_freeHead(invalidIndex),
+		m_size(0)
+	{}
+
+	void Reserve(size_t capacity)
+	{
+		m_slots.reserve(capacity);
+	}
+
+	Key Insert(const T& value)
+	{
+		uint32_t index;
+
+		if (m_freeHead != invalidIndex)
+		{
+			index = m_freeHead;
+			m_freeHead = m_slots[index].nextFree;
+		}
+		else
+		{
+			index = static_cast<uint32_t>(m_slots.size());
+			m_slots.emplace_back();
+		}
+
+		auto& slot = m_slots[index];
+		slot.value = value;
+		slot.alive = true;
+		slot.nextFree = invalidIndex;
+		++m_size;
+
+		return Key{ index, slot.generation };
+	}
+
+	T* Find(Key key)
+	{
+		if (key.index >= m_slots.size())
+		{
+			return nullptr;
+		}
+
+		auto& slot = m_slots[key.index];
+		return slot.alive && slot.generation == key.generation ? &slot.value : nullptr;
+	}
+
+	const T* Find(Key key) const
+	{
+		return const_cast<SlotMap*>(this)->Find(key);
+	}
+
+	bool Erase(Key key)
+	{
+		if (Find(key) == nullptr)
+		{
+			return false;
+		}
+
+		auto& slot = m_slots[key.index];
+		slot.alive = false;
+		++slot.generation;
+		slot.nextFree = m_freeHead;
+		m_freeHead = key.index;
+		--m_size;
+
+		return true;
+	}
+
+	template<typename Fn>
+	void ForEach(Fn&& fn)
+	{
+		for (auto& slot : m_slots)
+		{
+			if (slot.alive)
+			{
+				fn(slot.value);
+			}
+		}
+	}
+
+	// Erases the values pred returns true for
+	template<typename Pred>
+	void EraseIf(Pred&& pred)
+	{
+		for (uint32_t i = 0; i < m_slots.size(); ++i)
+		{
+			auto& slot = m_slots[i];
+
+			if (slot.alive && pred(slot.value))
+			{
+				Erase(Key{ i, slot.generation });
+			}
+		}
+	}
+
+	size_t GetSize() const
+	{
+		return m_size;
+	}
+
+private:
+	struct Slot
+	{
+		Slot() :
+			value(),
+			generation(0),
+			nextFree(invalidIndex),
+			alive(false)
+		{}
+
+		T value;
+		uint32_t generation;
+		uint32_t nextFree;
+		bool alive;
+	};
+
+	std::vector<Slot> m_slots;
+	uint32_t m_freeHead;
+	size_t m_size;
+};
\ No newline at end of file
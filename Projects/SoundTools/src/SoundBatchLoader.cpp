@@ -0,0 +1,215 @@
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AlFormat.h"
+#include "WorkStealingPool.h"
+
+#include "SoundTools/SoundBatchLoader.h"
+#include "SoundTools/WaveBuffer.h"
+
+namespace
+{
+	// Samples of a file ready for alBufferData
+	struct LoadedFile
+	{
+		size_t index;
+		std::unique_ptr<WaveBuffer> wave;
+		std::vector<uint8_t> converted;
+		AlBufferData prepared;
+		bool failed;
+		std::string error;
+	};
+
+	struct FileState
+	{
+		std::string filename;
+		std::shared_ptr<SoundBuffer> buffer;
+		std::string error;
+	};
+}
+
+class SoundBatchLoader::Impl
+{
+public:
+	Impl(size_t threadsCount) :
+		support(GetAlFormatSupport()),
+		handledCount(0),
+		pool(threadsCount)
+	{}
+
+	LoadedFile Read(size_t index, const std::string& filename) const
+	{
+		LoadedFile loaded;
+		loaded.index = index;
+		loaded.failed = false;
+
+		try
+		{
+			// Copied rather than mapped, so the disk is read here and not on the context thread
+			loaded.wave = std::make_unique<WaveBuffer>(filename.c_str(), WaveBufferStorage::Copy);
+
+			auto& wave = *loaded.wave;
+			loaded.prepared = PrepareBufferData(
+				support,
+				wave.GetChannelsCount(), wave.GetBitsPerSample(),
+				wave.GetData(), wave.GetDataSize(),
+				wave.GetEncoding(), wave.GetBlockAlign(),
+				loaded.converted);
+		}
+		catch (const std::exception& ex)
+		{
+			loaded.failed = true;
+			loaded.error = ex.what();
+		}
+
+		return loaded;
+	}
+
+	void Upload(LoadedFile& loaded)
+	{
+		auto& file = files[loaded.index];
+
+		if (loaded.failed)
+		{
+			file.error = std::move(loaded.error);
+			return;
+		}
+
+		auto& wave = *loaded.wave;
+		auto& prepared = loaded.prepared;
+
+		// Already in a format the context takes, so only the buffer is created here
+		try
+		{
+			auto duration = static_cast<double>(wave.GetFramesCount()) / wave.GetSampleRate();
+			file.buffer.reset(new SoundBuffer(prepared, wave.GetSampleRate(), duration));
+		}
+		catch (const std::exception& ex)
+		{
+			file.error = ex.what();
+		}
+	}
+
+	AlFormatSupport support;
+	std::vector<FileState> files;
+	size_t handledCount;
+	std::mutex readyMutex;
+	std::condition_variable readyChanged;
+	std::deque<LoadedFile> ready;
+	// Declared last so the workers are stopped before the rest goes away
+	WorkStealingPool pool;
+};
+
+SoundBatchLoader::SoundBatchLoader(size_t threadsCount) :
+	m_d(std::make_unique<Impl>(threadsCount))
+{
+}
+
+SoundBatchLoader::~SoundBatchLoader() = default;
+
+size_t SoundBatchLoader::Load(const char* const* filenames, size_t count)
+{
+	auto first = m_d->files.size();
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (filenames[i] == nullptr)
+		{
+			throw std::invalid_argument("File name can't be null");
+		}
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto index = first + i;
+		m_d->files.push_back(FileState{ filenames[i], nullptr, std::string() });
+
+		auto impl = m_d.get();
+		std::string filename = filenames[i];
+
+		m_d->pool.Submit([impl, index, filename]()
+		{
+			auto loaded = impl->Read(index, filename);
+
+			{
+				std::lock_guard<std::mutex> guard(impl->readyMutex);
+				impl->ready.push_back(std::move(loaded));
+			}
+
+			impl->readyChanged.notify_one();
+		});
+	}
+
+	return first;
+}
+
+size_t SoundBatchLoader::Upload(size_t maxCount, const std::function<void(size_t index)>& onUploaded)
+{
+	std::vector<LoadedFile> batch;
+
+	{
+		std::lock_guard<std::mutex> guard(m_d->readyMutex);
+
+		while (!m_d->ready.empty() && batch.size() < maxCount)
+		{
+			batch.push_back(std::move(m_d->ready.front()));
+			m_d->ready.pop_front();
+		}
+	}
+
+	for (auto& loaded : batch)
+	{
+		m_d->Upload(loaded);
+		++m_d->handledCount;
+
+		if (onUploaded)
+		{
+			onUploaded(loaded.index);
+		}
+	}
+
+	return batch.size();
+}
+
+void SoundBatchLoader::UploadAll(const std::function<void(size_t index)>& onUploaded)
+{
+	while (!IsDone())
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_d->readyMutex);
+			m_d->readyChanged.wait(lock, [this]() { return !m_d->ready.empty(); });
+		}
+
+		Upload(m_d->files.size(), onUploaded);
+	}
+}
+
+bool SoundBatchLoader::IsDone() const
+{
+	return m_d->handledCount == m_d->files.size();
+}
+
+size_t SoundBatchLoader::GetFilesCount() const
+{
+	return m_d->files.size();
+}
+
+const char* SoundBatchLoader::GetFilename(size_t index) const
+{
+	return m_d->files.at(index).filename.c_str();
+}
+
+std::shared_ptr<SoundBuffer> SoundBatchLoader::GetBuffer(size_t index) const
+{
+	return m_d->files.at(index).buffer;
+}
+
+const char* SoundBatchLoader::GetError(size_t index) const
+{
+	auto& error = m_d->files.at(index).error;
+	return error.empty() ? nullptr : error.c_str();
+}
\ No newline at end of file
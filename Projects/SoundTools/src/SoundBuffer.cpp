@@ -1,31 +1,18 @@
 #include <fstream>
-#include <vector>
 
+#include "Adpcm.h"
+#include "AlFormat.h"
 #include "OpenAlTools.h"
+#include "SampleConversion.h"
 
 #include "SoundTools/SoundBuffer.h"
 
-namespace
-{
-	ALenum ToAlFormat(short channels, short samples)
-	{
-		bool stereo = (channels > 1);
-
-		switch (samples)
-		{
-		case 16: return stereo ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
-		case 8:  return stereo ? AL_FORMAT_STEREO8 : AL_FORMAT_MONO8;
-		}
-
-		throw std::invalid_argument("Unexpected format");
-	}
-}
-
 class SoundBuffer::Impl
 {
 public:
 	Impl() :
-		alBuffer(alInvalidId)
+		alBuffer(alInvalidId),
+		duration(0)
 	{
 	}
 
@@ -52,23 +39,42 @@ public:
 	}
 
 	ALuint alBuffer;
+	double duration;
 };
 
 SoundBuffer::SoundBuffer(
 	size_t channelsCount, size_t bitsPerSample, size_t sampleRate,
-	const void* data, size_t dataSize)
+	const void* data, size_t dataSize,
+	SampleEncoding encoding,
+	size_t blockAlign)
 {
+	if (IsAdpcm(encoding) && blockAlign == 0)
+	{
+		blockAlign = GetDefaultAdpcmBlockAlign(encoding, channelsCount);
+	}
+
 	m_d = std::make_unique<Impl>();
+	m_d->duration = static_cast<double>(GetFramesCount(encoding, channelsCount, bitsPerSample, blockAlign, dataSize)) / sampleRate;
 
 	// Make new OpenAL buffer
-	OpenAlCallVoid(alGenBuffers, 1, &m_d->alBuffer);
+	OpenAlCallVoidStrict(alGenBuffers, 1, &m_d->alBuffer);
 
 	// Assign buffer data
-	OpenAlCallVoid(alBufferData,
+	UploadBufferData(
 		m_d->alBuffer,
-		ToAlFormat(channelsCount, bitsPerSample), data,
-		static_cast<int>(dataSize),
-		static_cast<int>(sampleRate));
+		channelsCount, bitsPerSample, sampleRate,
+		data, dataSize,
+		encoding,
+		blockAlign);
+}
+
+SoundBuffer::SoundBuffer(const AlBufferData& prepared, size_t sampleRate, double duration) :
+	m_d(std::make_unique<Impl>())
+{
+	m_d->duration = duration;
+
+	OpenAlCallVoidStrict(alGenBuffers, 1, &m_d->alBuffer);
+	UploadBufferData(m_d->alBuffer, prepared, sampleRate);
 }
 
 SoundBuffer::SoundBuffer(SoundBuffer&&) = default;
@@ -79,4 +85,10 @@ size_t SoundBuffer::GetId() const
 {
 	m_d->Check();
 	return m_d->alBuffer;
+}
+
+double SoundBuffer::GetDuration() const
+{
+	m_d->Check();
+	return m_d->duration;
 }
\ No newline at end of file
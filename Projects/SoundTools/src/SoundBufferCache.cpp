@@ -0,0 +1,238 @@
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Hash.h"
+#include "PathTools.h"
+
+#include "SoundTools/SoundBufferCache.h"
+#include "SoundTools/WaveBuffer.h"
+
+namespace
+{
+	uint64_t HashWaveContent(const WaveBuffer& wave)
+	{
+		uint64_t format[] =
+		{
+			wave.GetChannelsCount(),
+			wave.GetBitsPerSample(),
+			wave.GetSampleRate(),
+			static_cast<uint64_t>(wave.GetEncoding()),
+			wave.GetBlockAlign()
+		};
+
+		auto hash = HashBytes(format, sizeof(format));
+		return HashBytes(wave.GetData(), wave.GetDataSize(), hash);
+	}
+
+	// Compares the samples with the file the cached buffer was loaded from
+	bool IsSameContent(const WaveBuffer& wave, const std::string& path)
+	{
+		try
+		{
+			WaveBuffer cached(path.c_str(), WaveBufferStorage::Mapped);
+
+			return
+				wave.GetChannelsCount() == cached.GetChannelsCount() &&
+				wave.GetBitsPerSample() == cached.GetBitsPerSample() &&
+				wave.GetSampleRate() == cached.GetSampleRate() &&
+				wave.GetEncoding() == cached.GetEncoding() &&
+				wave.GetBlockAlign() == cached.GetBlockAlign() &&
+				wave.GetDataSize() == cached.GetDataSize() &&
+				std::memcmp(wave.GetData(), cached.GetData(), wave.GetDataSize()) == 0;
+		}
+		catch (const std::exception&)
+		{
+			// The file changed or is gone since it was cached
+			return false;
+		}
+	}
+}
+
+class SoundBufferCache::Impl
+{
+public:
+	Impl(bool deduplicateContent) :
+		deduplicateContent(deduplicateContent),
+		stats()
+	{}
+
+	struct ContentEntry
+	{
+		std::shared_ptr<SoundBuffer> buffer;
+		// The file the buffer was loaded from, to tell hash collisions apart
+		std::string path;
+	};
+
+	static const std::shared_ptr<SoundBuffer>& GetBuffer(const std::shared_ptr<SoundBuffer>& buffer)
+	{
+		return buffer;
+	}
+
+	static const std::shared_ptr<SoundBuffer>& GetBuffer(const ContentEntry& entry)
+	{
+		return entry.buffer;
+	}
+
+	template<typename Map>
+	static void CountReferences(const Map& map, std::unordered_map<const SoundBuffer*, long>& references)
+	{
+		for (auto& entry : map)
+		{
+			++references[GetBuffer(entry.second).get()];
+		}
+	}
+
+	template<typename Map>
+	static void EraseUnreferenced(Map& map, std::unordered_map<const SoundBuffer*, long>& references)
+	{
+		for (auto it = map.begin(); it != map.end();)
+		{
+			auto& buffer = GetBuffer(it->second);
+			auto& count = references[buffer.get()];
+
+			if (buffer.use_count() == count)
+			{
+				it = map.erase(it);
+				--count;
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	bool deduplicateContent;
+	std::unordered_map<std::string, std::shared_ptr<SoundBuffer>> byPath;
+	std::unordered_multimap<uint64_t, ContentEntry> byContent;
+	SoundBufferCacheStats stats;
+	mutable std::mutex mutex;
+};
+
+SoundBufferCache::SoundBufferCache(bool deduplicateContent) :
+	m_d(std::make_unique<Impl>(deduplicateContent))
+{
+}
+
+SoundBufferCache::~SoundBufferCache() = default;
+
+std::shared_ptr<SoundBuffer> SoundBufferCache::Get(const char* filename)
+{
+	auto path = GetCanonicalPath(filename);
+
+	{
+		std::lock_guard<std::mutex> guard(m_d->mutex);
+		auto it = m_d->byPath.find(path);
+
+		if (it != m_d->byPath.end())
+		{
+			++m_d->stats.hits;
+			return it->second;
+		}
+
+		++m_d->stats.misses;
+	}
+
+	// Load without holding the lock so other files can be served meanwhile
+	WaveBuffer wave(path.c_str(), WaveBufferStorage::Mapped);
+	uint64_t contentHash = 0;
+
+	if (m_d->deduplicateContent)
+	{
+		contentHash = HashWaveContent(wave);
+
+		// A matching hash may be a collision, the samples are compared outside the lock
+		std::vector<Impl::ContentEntry> candidates;
+		{
+			std::lock_guard<std::mutex> guard(m_d->mutex);
+			auto range = m_d->byContent.equal_range(contentHash);
+
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				candidates.push_back(it->second);
+			}
+		}
+
+		for (auto& candidate : candidates)
+		{
+			if (IsSameContent(wave, candidate.path))
+			{
+				std::lock_guard<std::mutex> guard(m_d->mutex);
+				++m_d->stats.contentHits;
+				return m_d->byPath.emplace(path, candidate.buffer).first->second;
+			}
+		}
+	}
+
+	auto buffer = std::make_shared<SoundBuffer>(wave.MakeSoundBuffer());
+
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+
+	// Another thread may have loaded the same file in the meantime
+	auto inserted = m_d->byPath.emplace(path, buffer);
+	if (inserted.second && m_d->deduplicateContent)
+	{
+		m_d->byContent.emplace(contentHash, Impl::ContentEntry{ buffer, path });
+	}
+
+	return inserted.first->second;
+}
+
+std::shared_ptr<SoundBuffer> SoundBufferCache::Find(const char* filename)
+{
+	auto path = GetCanonicalPath(filename);
+
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	auto it = m_d->byPath.find(path);
+
+	if (it == m_d->byPath.end())
+	{
+		++m_d->stats.misses;
+		return nullptr;
+	}
+
+	++m_d->stats.hits;
+	return it->second;
+}
+
+void SoundBufferCache::Insert(const char* filename, std::shared_ptr<SoundBuffer> buffer)
+{
+	auto path = GetCanonicalPath(filename);
+
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	m_d->byPath.emplace(path, std::move(buffer));
+}
+
+void SoundBufferCache::Trim()
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+
+	// Buffers whose only owners are the cache's own map entries are unused
+	std::unordered_map<const SoundBuffer*, long> references;
+	Impl::CountReferences(m_d->byPath, references);
+	Impl::CountReferences(m_d->byContent, references);
+
+	Impl::EraseUnreferenced(m_d->byPath, references);
+	Impl::EraseUnreferenced(m_d->byContent, references);
+}
+
+void SoundBufferCache::Clear()
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	m_d->byPath.clear();
+	m_d->byContent.clear();
+}
+
+SoundBufferCacheStats SoundBufferCache::GetStats() const
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+
+	auto stats = m_d->stats;
+	stats.buffersCount = m_d->deduplicateContent ? m_d->byContent.size() : m_d->byPath.size();
+
+	return stats;
+}
\ No newline at end of file
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <AL/alext.h>
+
+#include "SpscRing.h"
+
+#include "SoundTools/SoundCaptureDevice.h"
+#include "SoundTools/WaveWriter.h"
+
+namespace
+{
+	// How often the capture thread drains the device, the latency it adds
+	constexpr auto capturePeriod = std::chrono::milliseconds(5);
+
+	ALenum ToCaptureFormat(const SoundRenderFormat& format)
+	{
+		if (format.channelsCount == 1 || format.channelsCount == 2)
+		{
+			bool stereo = (format.channelsCount > 1);
+
+			if (format.encoding == SampleEncoding::Pcm && format.bitsPerSample == 8)
+			{
+				return stereo ? AL_FORMAT_STEREO8 : AL_FORMAT_MONO8;
+			}
+
+			if (format.encoding == SampleEncoding::Pcm && format.bitsPerSample == 16)
+			{
+				return stereo ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
+			}
+
+			if (format.encoding == SampleEncoding::Float && format.bitsPerSample == 32)
+			{
+				return stereo ? AL_FORMAT_STEREO_FLOAT32 : AL_FORMAT_MONO_FLOAT32;
+			}
+		}
+
+		throw std::invalid_argument("Unsupported capture format");
+	}
+
+	size_t GetRingFrames(const SoundRenderFormat& format, double ringDuration, size_t deviceFrames)
+	{
+		if (format.sampleRate == 0 || !(ringDuration > 0))
+		{
+			throw std::invalid_argument("Invalid capture format");
+		}
+
+		// The ring takes at least one device buffer, so a single drain always fits
+		return std::max(static_cast<size_t>(ringDuration * format.sampleRate), deviceFrames);
+	}
+}
+
+class SoundCaptureDevice::Impl
+{
+public:
+	Impl(const SoundRenderFormat& format, const char* name, double ringDuration) :
+		device(nullptr),
+		format(format),
+		alFormat(ToCaptureFormat(format)),
+		frameSize(format.channelsCount * format.bitsPerSample / 8),
+		deviceFrames(std::max<size_t>(format.sampleRate / 5, 1)),
+		ring(frameSize, GetRingFrames(format, ringDuration, deviceFrames)),
+		droppedFrames(0),
+		capturing(false),
+		exit(false)
+	{
+		// The device holds 200 ms, plenty for a thread draining it every few milliseconds
+		device = alcCaptureOpenDevice(
+			name,
+			static_cast<ALCuint>(format.sampleRate),
+			alFormat,
+			static_cast<ALCsizei>(deviceFrames));
+
+		if (device == nullptr)
+		{
+			throw std::runtime_error("Failed to initialize capture device");
+		}
+
+		discarded.resize(deviceFrames * frameSize);
+
+		thread = std::thread([this]()
+		{
+			CaptureThread();
+		});
+	}
+
+	~Impl()
+	{
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			exit = true;
+		}
+
+		wakeUp.notify_all();
+		thread.join();
+
+		if (capturing)
+		{
+			alcCaptureStop(device);
+		}
+
+		auto closeResult = alcCaptureCloseDevice(device);
+		assert(closeResult);
+	}
+
+	// Moves everything captured so far into the ring, called with the mutex locked
+	void Drain()
+	{
+		ALCint available = 0;
+		alcGetIntegerv(device, ALC_CAPTURE_SAMPLES, 1, &available);
+		auto count = static_cast<size_t>(std::max<ALCint>(available, 0));
+
+		SpscRing::Span spans[2];
+		ring.GetWriteSpans(count, spans);
+
+		for (auto& span : spans)
+		{
+			if (span.framesCount != 0)
+			{
+				alcCaptureSamples(device, span.data, static_cast<ALCsizei>(span.framesCount));
+			}
+		}
+
+		auto captured = spans[0].framesCount + spans[1].framesCount;
+		ring.CommitWrite(captured);
+		count -= captured;
+
+		// Frames that don't fit are still taken out, or the device would overrun and stall
+		while (count > 0)
+		{
+			auto discardedCount = std::min(count, deviceFrames);
+			alcCaptureSamples(device, discarded.data(), static_cast<ALCsizei>(discardedCount));
+			droppedFrames.fetch_add(discardedCount, std::memory_order_relaxed);
+			count -= discardedCount;
+		}
+	}
+
+	void CaptureThread()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (!wakeUp.wait_for(lock, capturePeriod, [this]() { return exit; }))
+		{
+			if (capturing)
+			{
+				Drain();
+			}
+		}
+	}
+
+	ALCdevice* device;
+	SoundRenderFormat format;
+	ALenum alFormat;
+	size_t frameSize;
+	size_t deviceFrames;
+	SpscRing ring;
+	std::vector<uint8_t> discarded;
+	std::atomic<uint64_t> droppedFrames;
+
+	bool capturing;
+	bool exit;
+	mutable std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::thread thread;
+};
+
+SoundCaptureDevice::SoundCaptureDevice(const SoundRenderFormat& format, const char* name, double ringDuration) :
+	m_d(std::make_unique<Impl>(format, name, ringDuration))
+{
+}
+
+SoundCaptureDevice::~SoundCaptureDevice() = default;
+
+void* SoundCaptureDevice::GetHandle() const
+{
+	return m_d->device;
+}
+
+const SoundRenderFormat& SoundCaptureDevice::GetFormat() const
+{
+	return m_d->format;
+}
+
+void SoundCaptureDevice::Start()
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+
+	if (!m_d->capturing)
+	{
+		alcCaptureStart(m_d->device);
+		m_d->capturing = true;
+	}
+}
+
+void SoundCaptureDevice::Stop()
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+
+	if (m_d->capturing)
+	{
+		alcCaptureStop(m_d->device);
+		m_d->Drain();
+		m_d->capturing = false;
+	}
+}
+
+bool SoundCaptureDevice::IsCapturing() const
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	return m_d->capturing;
+}
+
+size_t SoundCaptureDevice::GetAvailableFrames() const
+{
+	return m_d->ring.GetReadable();
+}
+
+uint64_t SoundCaptureDevice::GetDroppedFrames() const
+{
+	return m_d->droppedFrames.load(std::memory_order_relaxed);
+}
+
+size_t SoundCaptureDevice::Read(void* buffer, size_t framesCount)
+{
+	SpscRing::Span spans[2];
+	m_d->ring.GetReadSpans(framesCount, spans);
+
+	auto position = static_cast<uint8_t*>(buffer);
+	for (auto& span : spans)
+	{
+		std::memcpy(position, span.data, span.framesCount * m_d->frameSize);
+		position += span.framesCount * m_d->frameSize;
+	}
+
+	auto count = spans[0].framesCount + spans[1].framesCount;
+	m_d->ring.CommitRead(count);
+
+	return count;
+}
+
+size_t SoundCaptureDevice::Read(WaveWriter& writer)
+{
+	SpscRing::Span spans[2];
+	m_d->ring.GetReadSpans(m_d->ring.GetReadable(), spans);
+
+	// Committed span by span, so frames already in the file aren't written again after a failure
+	size_t count = 0;
+	for (auto& span : spans)
+	{
+		writer.Write(span.data, span.framesCount * m_d->frameSize);
+		m_d->ring.CommitRead(span.framesCount);
+		count += span.framesCount;
+	}
+
+	return count;
+}
+
+WaveBuffer SoundCaptureDevice::Read()
+{
+	auto& format = m_d->format;
+	auto framesCount = m_d->ring.GetReadable();
+
+	std::unique_ptr<uint8_t[]> data(new uint8_t[framesCount * m_d->frameSize]);
+	auto dataSize = Read(data.get(), framesCount) * m_d->frameSize;
+
+	return WaveBuffer(
+		format.channelsCount, format.bitsPerSample, format.sampleRate,
+		std::move(data), dataSize,
+		format.encoding);
+}
\ No newline at end of file
@@ -1,11 +1,33 @@
 #include "SoundTools/SoundDevice.h"
 
 #include <stdexcept>
+#include <vector>
 
+#include <AL/alext.h>
+
+#include "AlFormat.h"
 #include "OpenAlTools.h"
+#include "SourceBatch.h"
 
 #include "SoundTools/SoundContext.h"
 
+namespace
+{
+	void AppendAttribute(std::vector<ALCint>& attributes, ALCenum name, size_t value)
+	{
+		if (value != 0)
+		{
+			attributes.push_back(name);
+			attributes.push_back(static_cast<ALCint>(value));
+		}
+	}
+
+	size_t ToSize(ALCint value)
+	{
+		return value > 0 ? static_cast<size_t>(value) : 0;
+	}
+}
+
 class SoundContext::Impl
 {
 public:
@@ -13,6 +35,8 @@ public:
 	{
 		if (context != nullptr)
 		{
+			ForgetDeferredUpdates(context);
+			OpenAlForgetContext(context);
 			alcDestroyContext(context);
 		}
 	}
@@ -26,16 +50,55 @@ public:
 	ALCcontext* context;
 };
 
-SoundContext::SoundContext(SoundDevice* device)
+SoundContext::SoundContext(SoundDevice* device, const SoundContextConfig& config)
 {
 	if (device == nullptr)
 	{
 		throw std::invalid_argument("Could not initialize context with null device");
 	}
 
+	std::vector<ALCint> attributes;
+
+	// Loopback devices learn their output format from the context
+	if (device->IsLoopback())
+	{
+		auto& format = device->GetRenderFormat();
+		attributes.insert(attributes.end(),
+		{
+			ALC_FORMAT_CHANNELS_SOFT, ToAlcChannels(format.channelsCount),
+			ALC_FORMAT_TYPE_SOFT, ToAlcSampleType(format.encoding, format.bitsPerSample),
+			ALC_FREQUENCY, static_cast<ALCint>(format.sampleRate)
+		});
+
+		if (config.frequency != 0 && config.frequency != format.sampleRate)
+		{
+			throw std::invalid_argument("Loopback contexts render at the sample rate of the device");
+		}
+	}
+	else
+	{
+		AppendAttribute(attributes, ALC_FREQUENCY, config.frequency);
+	}
+
+	AppendAttribute(attributes, ALC_REFRESH, config.refreshRate);
+	AppendAttribute(attributes, ALC_MONO_SOURCES, config.monoSourcesCount);
+	AppendAttribute(attributes, ALC_STEREO_SOURCES, config.stereoSourcesCount);
+
+	if (config.sync)
+	{
+		attributes.insert(attributes.end(), { ALC_SYNC, ALC_TRUE });
+	}
+
+	attributes.push_back(0);
+
 	m_d = std::make_unique<Impl>();
 	m_d->device = device;
-	m_d->context = alcCreateContext(m_d->GetDevice(), nullptr);
+	m_d->context = alcCreateContext(m_d->GetDevice(), attributes.data());
+
+	if (m_d->context == nullptr)
+	{
+		throw std::runtime_error("Failed to create sound context");
+	}
 }
 
 SoundContext::SoundContext(SoundContext&& that) = default;
@@ -50,4 +113,42 @@ void* SoundContext::GetHandle() const
 void SoundContext::SetCurrent() const
 {
 	OpenAlCall(alcMakeContextCurrent, m_d->context);
+}
+
+SoundContextCapabilities SoundContext::GetCapabilities() const
+{
+	auto device = m_d->GetDevice();
+
+	ALCint attributesSize = 0;
+	alcGetIntegerv(device, ALC_ATTRIBUTES_SIZE, 1, &attributesSize);
+
+	std::vector<ALCint> attributes(ToSize(attributesSize));
+	if (!attributes.empty())
+	{
+		alcGetIntegerv(device, ALC_ALL_ATTRIBUTES, attributesSize, attributes.data());
+	}
+
+	SoundContextCapabilities capabilities = {};
+
+	// Name and value pairs up to a zero name
+	for (size_t i = 0; i + 1 < attributes.size() && attributes[i] != 0; i += 2)
+	{
+		auto value = attributes[i + 1];
+
+		switch (attributes[i])
+		{
+		case ALC_FREQUENCY: capabilities.frequency = ToSize(value); break;
+		case ALC_REFRESH: capabilities.refreshRate = ToSize(value); break;
+		case ALC_MONO_SOURCES: capabilities.monoSourcesCount = ToSize(value); break;
+		case ALC_STEREO_SOURCES: capabilities.stereoSourcesCount = ToSize(value); break;
+		case ALC_SYNC: capabilities.sync = value != ALC_FALSE; break;
+		}
+	}
+
+	return capabilities;
+}
+
+void SoundContext::CheckErrors() const
+{
+	OpenAlFlushErrors();
 }
\ No newline at end of file
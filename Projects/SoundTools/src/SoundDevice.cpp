@@ -1,6 +1,9 @@
 #include <cassert>
 #include <stdexcept>
 
+#include <AL/alext.h>
+
+#include "AlFormat.h"
 #include "OpenAlTools.h"
 
 #include "SoundTools/SoundDevice.h"
@@ -8,6 +11,13 @@
 class SoundDevice::Impl
 {
 public:
+	Impl() :
+		device(nullptr),
+		loopback(false),
+		renderFormat(),
+		renderSamples(nullptr)
+	{}
+
 	~Impl()
 	{
 		if (device != nullptr)
@@ -17,7 +27,18 @@ public:
 		}
 	}
 
+	void CheckLoopback() const
+	{
+		if (!loopback)
+		{
+			throw std::runtime_error("Only loopback devices can render on demand");
+		}
+	}
+
 	ALCdevice* device;
+	bool loopback;
+	SoundRenderFormat renderFormat;
+	LPALCRENDERSAMPLESSOFT renderSamples;
 };
 
 SoundDevice::SoundDevice(SoundDevice&& that) = default;
@@ -31,6 +52,49 @@ SoundDevice::SoundDevice(const char* name) :
 		throw std::runtime_error("Failed to initialize sound device");
 	}
 }
+
+SoundDevice::SoundDevice(const SoundRenderFormat& renderFormat) :
+	m_d(std::make_unique<Impl>())
+{
+	if (!alcIsExtensionPresent(nullptr, "ALC_SOFT_loopback"))
+	{
+		throw std::runtime_error("Loopback devices are not supported");
+	}
+
+	auto openDevice = reinterpret_cast<LPALCLOOPBACKOPENDEVICESOFT>(
+		alcGetProcAddress(nullptr, "alcLoopbackOpenDeviceSOFT"));
+	auto isFormatSupported = reinterpret_cast<LPALCISRENDERFORMATSUPPORTEDSOFT>(
+		alcGetProcAddress(nullptr, "alcIsRenderFormatSupportedSOFT"));
+	m_d->renderSamples = reinterpret_cast<LPALCRENDERSAMPLESSOFT>(
+		alcGetProcAddress(nullptr, "alcRenderSamplesSOFT"));
+
+	if (openDevice == nullptr || isFormatSupported == nullptr || m_d->renderSamples == nullptr)
+	{
+		throw std::runtime_error("Loopback devices are not supported");
+	}
+
+	m_d->device = openDevice(nullptr);
+
+	if (m_d->device == nullptr)
+	{
+		throw std::runtime_error("Failed to initialize sound device");
+	}
+
+	auto supported = isFormatSupported(
+		m_d->device,
+		static_cast<ALCsizei>(renderFormat.sampleRate),
+		ToAlcChannels(renderFormat.channelsCount),
+		ToAlcSampleType(renderFormat.encoding, renderFormat.bitsPerSample));
+
+	if (!supported)
+	{
+		throw std::invalid_argument("Unsupported render format");
+	}
+
+	m_d->loopback = true;
+	m_d->renderFormat = renderFormat;
+}
+
 SoundDevice::~SoundDevice() = default;
 
 void* SoundDevice::GetHandle() const
@@ -38,4 +102,35 @@ void* SoundDevice::GetHandle() const
 	return m_d->device;
 }
 
+bool SoundDevice::IsLoopback() const
+{
+	return m_d->loopback;
+}
+
+const SoundRenderFormat& SoundDevice::GetRenderFormat() const
+{
+	m_d->CheckLoopback();
+	return m_d->renderFormat;
+}
+
+void SoundDevice::Render(void* buffer, size_t framesCount) const
+{
+	m_d->CheckLoopback();
+	m_d->renderSamples(m_d->device, buffer, static_cast<ALCsizei>(framesCount));
+}
+
+WaveBuffer SoundDevice::Render(size_t framesCount) const
+{
+	auto& format = GetRenderFormat();
+	auto dataSize = framesCount * format.channelsCount * format.bitsPerSample / 8;
+
+	std::unique_ptr<uint8_t[]> data(new uint8_t[dataSize]);
+	Render(data.get(), framesCount);
+
+	return WaveBuffer(
+		format.channelsCount, format.bitsPerSample, format.sampleRate,
+		std::move(data), dataSize,
+		format.encoding);
+}
+
 SoundDevice& SoundDevice::operator=(SoundDevice&& that) = default;
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "OpenAlTools.h"
+
+#include "SoundTools/SoundBuffer.h"
+#include "SoundTools/SoundLifecycleManager.h"
+#include "SoundTools/SoundSource.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+}
+
+class SoundLifecycleManager::Impl
+{
+public:
+	struct Entry
+	{
+		uint64_t id;
+		SoundSource source;
+		std::shared_ptr<SoundBuffer> buffer;
+		SoundCompletionCallback onComplete;
+		Clock::time_point checkAt;
+	};
+
+	struct Finished
+	{
+		uint64_t id;
+		SoundSource source;
+		SoundCompletionCallback onComplete;
+	};
+
+	Impl(std::chrono::milliseconds tick) :
+		tick(tick),
+		nextId(1),
+		exit(false)
+	{}
+
+	// Estimates when the source will stop on its own
+	Clock::time_point EstimateEnd(const Entry& entry, Clock::time_point now) const
+	{
+		auto id = static_cast<ALuint>(entry.source.GetId());
+
+		ALint state, looping;
+		OpenAlCallVoid(alGetSourcei, id, static_cast<ALenum>(AL_SOURCE_STATE), &state);
+		OpenAlCallVoid(alGetSourcei, id, static_cast<ALenum>(AL_LOOPING), &looping);
+
+		if (looping || entry.buffer == nullptr)
+		{
+			return Clock::time_point::max();
+		}
+
+		// Paused sources don't advance, look at them again next tick
+		if (state == AL_PAUSED)
+		{
+			return now + tick;
+		}
+
+		ALfloat pitch, offset;
+		OpenAlCallVoid(alGetSourcef, id, static_cast<ALenum>(AL_PITCH), &pitch);
+		OpenAlCallVoid(alGetSourcef, id, static_cast<ALenum>(AL_SEC_OFFSET), &offset);
+
+		auto remaining = std::max(0.0, entry.buffer->GetDuration() - offset) / std::max(pitch, 0.001f);
+		return now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(remaining));
+	}
+
+	void Remove(size_t index, std::vector<Finished>& finished)
+	{
+		auto& entry = entries[index];
+		indices.erase(entry.id);
+		finished.push_back({ entry.id, std::move(entry.source), std::move(entry.onComplete) });
+
+		// Keep the array compact by moving the last entry into the hole
+		if (index + 1 != entries.size())
+		{
+			entries[index] = std::move(entries.back());
+			indices[entries[index].id] = index;
+		}
+
+		entries.pop_back();
+	}
+
+	// Sources are deleted and callbacks run outside of the lock so callbacks can start new sounds
+	static void Complete(std::vector<Finished>& finished)
+	{
+		for (auto& item : finished)
+		{
+			// Release the AL source first, the callback may want to start another one
+			{
+				auto released = std::move(item.source);
+			}
+
+			if (item.onComplete)
+			{
+				item.onComplete(item.id);
+			}
+		}
+
+		finished.clear();
+	}
+
+	void TickThread()
+	{
+		std::vector<Finished> finished;
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (!wakeUp.wait_for(lock, tick, [this]() { return exit; }))
+		{
+			try
+			{
+				Collect(Clock::now(), finished);
+			}
+			catch (const std::exception&)
+			{
+				// Keep tracking the remaining sources, a failed pass is retried next tick
+			}
+
+			// Sources collected before a failure are completed all the same
+			lock.unlock();
+
+			try
+			{
+				Complete(finished);
+			}
+			catch (const std::exception&)
+			{
+				finished.clear();
+			}
+
+			lock.lock();
+		}
+	}
+
+	void Collect(Clock::time_point now, std::vector<Finished>& finished)
+	{
+		for (size_t i = 0; i < entries.size();)
+		{
+			auto& entry = entries[i];
+
+			if (entry.checkAt > now)
+			{
+				++i;
+				continue;
+			}
+
+			ALint state;
+			OpenAlCallVoid(alGetSourcei,
+				static_cast<ALuint>(entry.source.GetId()),
+				static_cast<ALenum>(AL_SOURCE_STATE),
+				&state);
+
+			if (state == AL_STOPPED)
+			{
+				Remove(i, finished);
+			}
+			else
+			{
+				entry.checkAt = EstimateEnd(entry, now);
+				++i;
+			}
+		}
+	}
+
+	std::chrono::milliseconds tick;
+	std::vector<Entry> entries;
+	std::unordered_map<uint64_t, size_t> indices;
+	uint64_t nextId;
+	bool exit;
+	mutable std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::thread thread;
+};
+
+SoundLifecycleManager::SoundLifecycleManager(std::chrono::milliseconds tick) :
+	m_d(std::make_unique<Impl>(tick))
+{
+	if (tick.count() > 0)
+	{
+		m_d->thread = std::thread([this]()
+		{
+			m_d->TickThread();
+		});
+	}
+}
+
+SoundLifecycleManager::~SoundLifecycleManager()
+{
+	if (m_d->thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_d->mutex);
+			m_d->exit = true;
+		}
+
+		m_d->wakeUp.notify_all();
+		m_d->thread.join();
+	}
+}
+
+uint64_t SoundLifecycleManager::Play(
+	SoundSource&& source,
+	std::shared_ptr<SoundBuffer> buffer,
+	SoundCompletionCallback onComplete)
+{
+	source.Play();
+
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+
+	// Estimated before the entry is tracked, a failure leaves nothing behind to complete later
+	Impl::Entry entry = { m_d->nextId, std::move(source), std::move(buffer), std::move(onComplete), Clock::time_point() };
+	entry.checkAt = m_d->EstimateEnd(entry, Clock::now());
+
+	auto id = m_d->nextId++;
+	m_d->entries.push_back(std::move(entry));
+	m_d->indices[id] = m_d->entries.size() - 1;
+
+	return id;
+}
+
+bool SoundLifecycleManager::Access(uint64_t id, const std::function<void(SoundSource&)>& fn)
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	auto it = m_d->indices.find(id);
+
+	if (it == m_d->indices.end())
+	{
+		return false;
+	}
+
+	// The caller may have changed looping, pitch or state: re-estimate on the next pass
+	auto& entry = m_d->entries[it->second];
+	fn(entry.source);
+	entry.checkAt = Clock::time_point();
+
+	return true;
+}
+
+void SoundLifecycleManager::Stop(uint64_t id)
+{
+	std::vector<Impl::Finished> finished;
+
+	{
+		std::lock_guard<std::mutex> guard(m_d->mutex);
+		auto it = m_d->indices.find(id);
+
+		if (it == m_d->indices.end())
+		{
+			return;
+		}
+
+		m_d->entries[it->second].source.Stop();
+		m_d->Remove(it->second, finished);
+	}
+
+	Impl::Complete(finished);
+}
+
+size_t SoundLifecycleManager::Update()
+{
+	std::vector<Impl::Finished> finished;
+	std::exception_ptr error;
+
+	{
+		std::lock_guard<std::mutex> guard(m_d->mutex);
+
+		try
+		{
+			m_d->Collect(Clock::now(), finished);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+	}
+
+	// Sources collected before a failure are already untracked, they must still complete
+	auto count = finished.size();
+	Impl::Complete(finished);
+
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+
+	return count;
+}
+
+size_t SoundLifecycleManager::GetActiveCount() const
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	return m_d->entries.size();
+}
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "MixerKernels.h"
+#include "SlotMap.h"
+
+#include "SoundTools/SoundMixer.h"
+
+namespace
+{
+	constexpr float minPitch = 0.001f;
+	constexpr size_t renderBlockFrames = 1024;
+
+	struct Voice
+	{
+		std::shared_ptr<const SoundMixerClip> clip;
+		double position;
+		float gain;
+		float pitch;
+		bool looping;
+	};
+
+	using VoiceMap = SlotMap<Voice>;
+
+	VoiceMap::Key ToKey(SoundMixerVoice voice)
+	{
+		return { voice.index, voice.generation };
+	}
+}
+
+class SoundMixer::Impl
+{
+public:
+	// Returns true when the voice has played to its end
+	bool MixVoice(Voice& voice, float* out, size_t framesCount) const
+	{
+		auto& clip = *voice.clip;
+		auto clipFrames = static_cast<double>(clip.GetFramesCount());
+		auto clipChannels = clip.GetChannelsCount();
+		auto step = static_cast<double>(voice.pitch) * clip.GetSampleRate() / sampleRate;
+
+		if (clipFrames == 0)
+		{
+			return true;
+		}
+
+		size_t done = 0;
+
+		while (done < framesCount)
+		{
+			if (voice.position >= clipFrames)
+			{
+				if (!voice.looping)
+				{
+					return true;
+				}
+
+				voice.position = std::fmod(voice.position, clipFrames);
+			}
+
+			// Frames left before the read position passes the end of the clip
+			auto available = static_cast<size_t>(std::ceil((clipFrames - voice.position) / step));
+			auto count = std::min(framesCount - done, std::max<size_t>(available, 1));
+			auto dst = out + done * channelsCount;
+
+			if (step == 1 && clipChannels == channelsCount && voice.position == std::floor(voice.position))
+			{
+				auto src = clip.GetSamples() + static_cast<size_t>(voice.position) * clipChannels;
+				MixAdd(src, dst, count * channelsCount, voice.gain);
+				voice.position += static_cast<double>(count);
+			}
+			else
+			{
+				voice.position = MixResampled(
+					clip.GetSamples(), clip.GetFramesCount(), clipChannels,
+					voice.position, step,
+					dst, count, channelsCount,
+					voice.gain);
+			}
+
+			done += count;
+		}
+
+		return voice.position >= clipFrames && !voice.looping;
+	}
+
+	size_t channelsCount;
+	size_t sampleRate;
+	VoiceMap voices;
+	std::vector<float> renderBlock;
+	SoundMixerStats stats;
+};
+
+SoundMixer::SoundMixer(size_t channelsCount, size_t sampleRate, size_t voicesCapacity) :
+	m_d(std::make_unique<Impl>())
+{
+	if (channelsCount == 0 || sampleRate == 0)
+	{
+		throw std::invalid_argument("Invalid mixer format");
+	}
+
+	m_d->channelsCount = channelsCount;
+	m_d->sampleRate = sampleRate;
+	m_d->voices.Reserve(voicesCapacity);
+	m_d->renderBlock.resize(renderBlockFrames * channelsCount);
+	m_d->stats = SoundMixerStats{ 0, 0, 0, 0 };
+}
+
+SoundMixer::~SoundMixer() = default;
+
+SoundMixerVoice SoundMixer::Play(
+	std::shared_ptr<const SoundMixerClip> clip,
+	float gain,
+	float pitch,
+	bool looping)
+{
+	if (clip == nullptr)
+	{
+		throw std::invalid_argument("Clip can't be null");
+	}
+
+	auto key = m_d->voices.Insert(Voice{ std::move(clip), 0, gain, std::max(pitch, minPitch), looping });
+	return SoundMixerVoice{ key.index, key.generation };
+}
+
+bool SoundMixer::Stop(SoundMixerVoice voice)
+{
+	auto found = m_d->voices.Find(ToKey(voice));
+
+	if (found == nullptr)
+	{
+		return false;
+	}
+
+	// Erased slots keep their value until reused, don't keep the clip alive
+	found->clip.reset();
+	return m_d->voices.Erase(ToKey(voice));
+}
+
+bool SoundMixer::IsPlaying(SoundMixerVoice voice) const
+{
+	return m_d->voices.Find(ToKey(voice)) != nullptr;
+}
+
+bool SoundMixer::SetGain(SoundMixerVoice voice, float gain)
+{
+	auto found = m_d->voices.Find(ToKey(voice));
+
+	if (found == nullptr)
+	{
+		return false;
+	}
+
+	found->gain = gain;
+	return true;
+}
+
+bool SoundMixer::SetPitch(SoundMixerVoice voice, float pitch)
+{
+	auto found = m_d->voices.Find(ToKey(voice));
+
+	if (found == nullptr)
+	{
+		return false;
+	}
+
+	found->pitch = std::max(pitch, minPitch);
+	return true;
+}
+
+bool SoundMixer::SetLooping(SoundMixerVoice voice, bool looping)
+{
+	auto found = m_d->voices.Find(ToKey(voice));
+
+	if (found == nullptr)
+	{
+		return false;
+	}
+
+	found->looping = looping;
+	return true;
+}
+
+void SoundMixer::Mix(float* out, size_t framesCount)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	std::memset(out, 0, framesCount * m_d->channelsCount * sizeof(float));
+
+	m_d->voices.EraseIf([&](Voice& voice)
+	{
+		if (!m_d->MixVoice(voice, out, framesCount))
+		{
+			return false;
+		}
+
+		voice.clip.reset();
+		return true;
+	});
+
+	auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	m_d->stats.mixedFrames += framesCount;
+	m_d->stats.mixSeconds += seconds;
+	m_d->stats.lastMixSeconds = seconds;
+}
+
+size_t SoundMixer::Render(SoundBackend& backend, size_t framesCount)
+{
+	framesCount = std::min(framesCount, backend.GetWritableFrames());
+
+	for (size_t done = 0; done < framesCount;)
+	{
+		auto count = std::min(framesCount - done, renderBlockFrames);
+		Mix(m_d->renderBlock.data(), count);
+		backend.Write(m_d->renderBlock.data(), count);
+		done += count;
+	}
+
+	return framesCount;
+}
+
+size_t SoundMixer::GetChannelsCount() const
+{
+	return m_d->channelsCount;
+}
+
+size_t SoundMixer::GetSampleRate() const
+{
+	return m_d->sampleRate;
+}
+
+SoundMixerStats SoundMixer::GetStats() const
+{
+	auto stats = m_d->stats;
+	stats.activeVoices = m_d->voices.GetSize();
+	return stats;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include <stdexcept>
+#include <vector>
+
+#include "Adpcm.h"
+#include "SampleConversion.h"
+
+#include "SoundTools/SoundMixerClip.h"
+#include "SoundTools/WaveBuffer.h"
+
+class SoundMixerClip::Impl
+{
+public:
+	size_t channelsCount;
+	size_t sampleRate;
+	std::vector<uint8_t> samples;
+};
+
+SoundMixerClip::SoundMixerClip(const WaveBuffer& wave) :
+	m_d(std::make_unique<Impl>())
+{
+	if (wave.GetChannelsCount() == 0 || wave.GetSampleRate() == 0)
+	{
+		throw std::invalid_argument("Invalid wave format");
+	}
+
+	m_d->channelsCount = wave.GetChannelsCount();
+	m_d->sampleRate = wave.GetSampleRate();
+
+	if (IsAdpcm(wave.GetEncoding()))
+	{
+		std::vector<uint8_t> pcm;
+		DecodeAdpcm(
+			wave.GetEncoding(), wave.GetChannelsCount(), wave.GetBlockAlign(),
+			wave.GetData(), wave.GetDataSize(),
+			pcm);
+		ConvertSamples(
+			SampleEncoding::Pcm, 16, pcm.data(), pcm.size(),
+			SampleEncoding::Float, 32, m_d->samples);
+	}
+	else
+	{
+		ConvertSamples(
+			wave.GetEncoding(), wave.GetBitsPerSample(), wave.GetData(), wave.GetDataSize(),
+			SampleEncoding::Float, 32, m_d->samples);
+	}
+}
+
+SoundMixerClip::~SoundMixerClip() = default;
+
+size_t SoundMixerClip::GetChannelsCount() const
+{
+	return m_d->channelsCount;
+}
+
+size_t SoundMixerClip::GetSampleRate() const
+{
+	return m_d->sampleRate;
+}
+
+size_t SoundMixerClip::GetFramesCount() const
+{
+	return m_d->samples.size() / (sizeof(float) * m_d->channelsCount);
+}
+
+const float* SoundMixerClip::GetSamples() const
+{
+	return reinterpret_cast<const float*>(m_d->samples.data());
+}
\ No newline at end of file
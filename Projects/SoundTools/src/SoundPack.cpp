@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "MappedFile.h"
+#include "SoundPackFormat.h"
+
+#include "SoundTools/SoundPack.h"
+
+class SoundPack::Impl
+{
+public:
+	const SoundPackEntry* Find(const char* name) const
+	{
+		auto hash = HashSoundName(name);
+		auto end = entries + entriesCount;
+		auto it = std::lower_bound(entries, end, hash, [](const SoundPackEntry& entry, uint64_t hash)
+		{
+			return entry.nameHash < hash;
+		});
+
+		for (; it != end && it->nameHash == hash; ++it)
+		{
+			if (std::strcmp(GetName(*it), name) == 0)
+			{
+				return it;
+			}
+		}
+
+		return nullptr;
+	}
+
+	const char* GetName(const SoundPackEntry& entry) const
+	{
+		if (entry.nameOffset >= namesSize)
+		{
+			throw std::runtime_error("Invalid sound pack entry");
+		}
+
+		return names + entry.nameOffset;
+	}
+
+	std::shared_ptr<const MappedFile> mapping;
+	const SoundPackEntry* entries;
+	size_t entriesCount;
+	const char* names;
+	size_t namesSize;
+};
+
+SoundPack::SoundPack(const char* filename) :
+	m_d(std::make_unique<Impl>())
+{
+	m_d->mapping = std::make_shared<const MappedFile>(filename);
+
+	auto data = m_d->mapping->GetData();
+	auto size = static_cast<uint64_t>(m_d->mapping->GetSize());
+
+	auto check = [](bool cond)
+	{
+		if (!cond)
+		{
+			throw std::invalid_argument("Invalid sound pack");
+		}
+	};
+
+	check(size >= sizeof(SoundPackHeader));
+
+	SoundPackHeader header;
+	std::memcpy(&header, data, sizeof(header));
+
+	check(IsSoundPackMagic(header.magic) && header.version == soundPackVersion);
+
+	// Entries are read in place and have to be aligned for it
+	check(header.entriesOffset <= size && header.entriesOffset % alignof(SoundPackEntry) == 0);
+	check(header.entriesCount <= (size - header.entriesOffset) / sizeof(SoundPackEntry));
+
+	// A terminated last name keeps every name lookup inside the block
+	check(header.namesOffset <= size && header.namesSize <= size - header.namesOffset);
+	check(header.namesSize == 0 ? header.entriesCount == 0 : data[header.namesOffset + header.namesSize - 1] == 0);
+
+	m_d->entries = reinterpret_cast<const SoundPackEntry*>(data + header.entriesOffset);
+	m_d->entriesCount = static_cast<size_t>(header.entriesCount);
+	m_d->names = reinterpret_cast<const char*>(data + header.namesOffset);
+	m_d->namesSize = static_cast<size_t>(header.namesSize);
+}
+
+SoundPack::~SoundPack() = default;
+
+size_t SoundPack::GetSoundsCount() const
+{
+	return m_d->entriesCount;
+}
+
+const char* SoundPack::GetName(size_t index) const
+{
+	if (index >= m_d->entriesCount)
+	{
+		throw std::out_of_range("Invalid sound index");
+	}
+
+	return m_d->GetName(m_d->entries[index]);
+}
+
+bool SoundPack::Contains(const char* name) const
+{
+	return m_d->Find(name) != nullptr;
+}
+
+WaveBuffer SoundPack::GetWave(const char* name) const
+{
+	auto entry = m_d->Find(name);
+
+	if (entry == nullptr)
+	{
+		throw std::out_of_range("Sound is not found in the pack");
+	}
+
+	return GetWave(static_cast<size_t>(entry - m_d->entries));
+}
+
+WaveBuffer SoundPack::GetWave(size_t index) const
+{
+	if (index >= m_d->entriesCount)
+	{
+		throw std::out_of_range("Invalid sound index");
+	}
+
+	auto& entry = m_d->entries[index];
+	auto size = static_cast<uint64_t>(m_d->mapping->GetSize());
+
+	if (entry.dataOffset > size || entry.dataSize > size - entry.dataOffset || !IsSoundPackEncoding(entry.encoding))
+	{
+		throw std::runtime_error("Invalid sound pack entry");
+	}
+
+	return WaveBuffer(
+		m_d->mapping, m_d->mapping->GetData() + entry.dataOffset, static_cast<size_t>(entry.dataSize),
+		entry.channelsCount, entry.bitsPerSample, entry.sampleRate,
+		static_cast<SampleEncoding>(entry.encoding), entry.blockAlign);
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "SoundPackFormat.h"
+
+#include "SoundTools/SoundPackBuilder.h"
+
+namespace
+{
+	struct PackedSound
+	{
+		std::string name;
+		uint64_t hash;
+		WaveBuffer wave;
+	};
+
+	uint64_t Align(uint64_t offset)
+	{
+		return (offset + soundPackAlignment - 1) / soundPackAlignment * soundPackAlignment;
+	}
+}
+
+class SoundPackBuilder::Impl
+{
+public:
+	std::vector<PackedSound> sounds;
+	std::unordered_set<std::string> names;
+};
+
+SoundPackBuilder::SoundPackBuilder() :
+	m_d(std::make_unique<Impl>())
+{
+}
+
+SoundPackBuilder::~SoundPackBuilder() = default;
+
+void SoundPackBuilder::Add(const char* name, WaveBuffer&& wave)
+{
+	if (!m_d->names.insert(name).second)
+	{
+		throw std::invalid_argument("Sound names in a pack have to be unique");
+	}
+
+	m_d->sounds.push_back(PackedSound{ name, HashSoundName(name), std::move(wave) });
+}
+
+size_t SoundPackBuilder::GetSoundsCount() const
+{
+	return m_d->sounds.size();
+}
+
+void SoundPackBuilder::Save(const char* filename) const
+{
+	// Index order is what lookups binary search
+	std::vector<const PackedSound*> order;
+	order.reserve(m_d->sounds.size());
+
+	for (auto& sound : m_d->sounds)
+	{
+		order.push_back(&sound);
+	}
+
+	std::sort(order.begin(), order.end(), [](const PackedSound* a, const PackedSound* b)
+	{
+		return a->hash != b->hash ? a->hash < b->hash : a->name < b->name;
+	});
+
+	SoundPackHeader header;
+	std::memcpy(header.magic, "STPK", sizeof(header.magic));
+	header.version = soundPackVersion;
+	header.entriesCount = order.size();
+	header.entriesOffset = sizeof(header);
+	header.namesOffset = header.entriesOffset + order.size() * sizeof(SoundPackEntry);
+	header.namesSize = 0;
+
+	std::vector<SoundPackEntry> entries(order.size());
+	std::string names;
+
+	for (size_t i = 0; i < order.size(); ++i)
+	{
+		auto& wave = order[i]->wave;
+		auto& entry = entries[i];
+
+		entry.nameHash = order[i]->hash;
+		entry.nameOffset = names.size();
+		entry.dataSize = wave.GetDataSize();
+		entry.channelsCount = static_cast<uint32_t>(wave.GetChannelsCount());
+		entry.bitsPerSample = static_cast<uint32_t>(wave.GetBitsPerSample());
+		entry.sampleRate = static_cast<uint32_t>(wave.GetSampleRate());
+		entry.blockAlign = static_cast<uint32_t>(wave.GetBlockAlign());
+		entry.encoding = static_cast<uint32_t>(wave.GetEncoding());
+		entry.reserved = 0;
+
+		names += order[i]->name;
+		names += '\0';
+	}
+
+	header.namesSize = names.size();
+
+	auto offset = Align(header.namesOffset + header.namesSize);
+	for (auto& entry : entries)
+	{
+		entry.dataOffset = offset;
+		offset = Align(offset + entry.dataSize);
+	}
+
+	std::ofstream file(filename,
+		std::ios::binary |
+		std::ios::out |
+		std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error("Could not create the file");
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(SoundPackEntry));
+	file.write(names.data(), names.size());
+
+	const char padding[soundPackAlignment] = {};
+	uint64_t position = header.namesOffset + header.namesSize;
+
+	for (size_t i = 0; i < order.size(); ++i)
+	{
+		file.write(padding, static_cast<std::streamsize>(entries[i].dataOffset - position));
+		file.write(static_cast<const char*>(order[i]->wave.GetData()), entries[i].dataSize);
+		position = entries[i].dataOffset + entries[i].dataSize;
+	}
+
+	if (!file.good())
+	{
+		throw std::runtime_error("Failed to write the sound pack");
+	}
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "Hash.h"
+
+#include "SoundTools/SampleEncoding.h"
+
+// Sound pack file layout, offsets are from the beginning of the file:
+// header, entries sorted by name hash and then name, zero-terminated names,
+// sample payloads each starting at a multiple of soundPackAlignment.
+// Everything is little-endian and read in place from the mapping.
+
+constexpr uint32_t soundPackVersion = 1;
+constexpr uint64_t soundPackAlignment = 64;
+
+struct SoundPackHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t entriesCount;
+	uint64_t entriesOffset;
+	uint64_t namesOffset;
+	uint64_t namesSize;
+};
+
+struct SoundPackEntry
+{
+	uint64_t nameHash;
+	// Relative to the names block
+	uint64_t nameOffset;
+	uint64_t dataOffset;
+	uint64_t dataSize;
+	uint32_t channelsCount;
+	uint32_t bitsPerSample;
+	uint32_t sampleRate;
+	uint32_t blockAlign;
+	uint32_t encoding;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(SoundPackHeader) == 40, "Sound pack header must have no padding");
+static_assert(sizeof(SoundPackEntry) == 56, "Sound pack entry must have no padding");
+
+inline bool IsSoundPackMagic(const char* magic)
+{
+	return std::memcmp(magic, "STPK", 4) == 0;
+}
+
+// Packs from a newer version may use encodings this one doesn't know
+inline bool IsSoundPackEncoding(uint32_t encoding)
+{
+	return encoding <= static_cast<uint32_t>(SampleEncoding::MsAdpcm);
+}
+
+inline uint64_t HashSoundName(const char* name)
+{
+	return HashBytes(name, std::strlen(name));
+}
\ No newline at end of file
@@ -0,0 +1,361 @@
+#include <vector>
+
+#include "Adpcm.h"
+#include "AlFormat.h"
+#include "OpenAlTools.h"
+#include "SampleConversion.h"
+#include "SlotMap.h"
+#include "SourceBatch.h"
+#include "SourceState.h"
+
+#include "SoundTools/SoundRegistry.h"
+#include "SoundTools/WaveBuffer.h"
+
+namespace
+{
+	struct BufferSlot
+	{
+		ALuint id;
+		double duration;
+	};
+
+	using BufferMap = SlotMap<BufferSlot>;
+	using SourceMap = SlotMap<ALuint>;
+
+	BufferMap::Key ToKey(SoundBufferHandle handle)
+	{
+		return { handle.index, handle.generation };
+	}
+
+	SourceMap::Key ToKey(SoundSourceHandle handle)
+	{
+		return { handle.index, handle.generation };
+	}
+
+	void ResetSource(ALuint id)
+	{
+		alSourceStop(id);
+		alSourcei(id, AL_BUFFER, 0);
+		alSourcef(id, AL_PITCH, 1);
+		alSourcef(id, AL_GAIN, 1);
+		alSource3f(id, AL_POSITION, 0, 0, 0);
+		alSource3f(id, AL_VELOCITY, 0, 0, 0);
+		alSourcei(id, AL_LOOPING, AL_FALSE);
+	}
+}
+
+class SoundRegistry::Impl
+{
+public:
+	~Impl()
+	{
+		sources.ForEach([this](ALuint id)
+		{
+			idleSources.push_back(id);
+		});
+
+		if (!idleSources.empty())
+		{
+			alDeleteSources(static_cast<ALsizei>(idleSources.size()), idleSources.data());
+		}
+
+		buffers.ForEach([](const BufferSlot& buffer)
+		{
+			alDeleteBuffers(1, &buffer.id);
+		});
+	}
+
+	ALuint FindSource(SoundSourceHandle handle) const
+	{
+		auto id = sources.Find(ToKey(handle));
+		return id != nullptr ? *id : alInvalidId;
+	}
+
+	SourceMap sources;
+	BufferMap buffers;
+	// Names of destroyed sources, reset and ready to be handed out again
+	std::vector<ALuint> idleSources;
+};
+
+SoundRegistry::SoundRegistry(size_t sourcesCapacity, size_t buffersCapacity) :
+	m_d(std::make_unique<Impl>())
+{
+	m_d->sources.Reserve(sourcesCapacity);
+	m_d->buffers.Reserve(buffersCapacity);
+	m_d->idleSources.reserve(sourcesCapacity);
+}
+
+SoundRegistry::~SoundRegistry() = default;
+
+SoundBufferHandle SoundRegistry::CreateBuffer(
+	size_t channelsCount, size_t bitsPerSample, size_t sampleRate,
+	const void* data, size_t dataSize,
+	SampleEncoding encoding,
+	size_t blockAlign)
+{
+	if (IsAdpcm(encoding) && blockAlign == 0)
+	{
+		blockAlign = GetDefaultAdpcmBlockAlign(encoding, channelsCount);
+	}
+
+	BufferSlot buffer;
+	buffer.duration = static_cast<double>(GetFramesCount(encoding, channelsCount, bitsPerSample, blockAlign, dataSize)) / sampleRate;
+	OpenAlCallVoidStrict(alGenBuffers, 1, &buffer.id);
+
+	try
+	{
+		UploadBufferData(buffer.id, channelsCount, bitsPerSample, sampleRate, data, dataSize, encoding, blockAlign);
+	}
+	catch (...)
+	{
+		alDeleteBuffers(1, &buffer.id);
+		throw;
+	}
+
+	auto key = m_d->buffers.Insert(buffer);
+	return SoundBufferHandle{ key.index, key.generation };
+}
+
+SoundBufferHandle SoundRegistry::CreateBuffer(const WaveBuffer& wave)
+{
+	return CreateBuffer(
+		wave.GetChannelsCount(), wave.GetBitsPerSample(), wave.GetSampleRate(),
+		wave.GetData(), wave.GetDataSize(),
+		wave.GetEncoding(), wave.GetBlockAlign());
+}
+
+bool SoundRegistry::DestroyBuffer(SoundBufferHandle buffer)
+{
+	auto slot = m_d->buffers.Find(ToKey(buffer));
+
+	if (slot == nullptr)
+	{
+		return false;
+	}
+
+	OpenAlCallVoid(alDeleteBuffers, 1, static_cast<const ALuint*>(&slot->id));
+	return m_d->buffers.Erase(ToKey(buffer));
+}
+
+bool SoundRegistry::IsValid(SoundBufferHandle buffer) const
+{
+	return m_d->buffers.Find(ToKey(buffer)) != nullptr;
+}
+
+double SoundRegistry::GetDuration(SoundBufferHandle buffer) const
+{
+	auto slot = m_d->buffers.Find(ToKey(buffer));
+	return slot != nullptr ? slot->duration : 0;
+}
+
+SoundSourceHandle SoundRegistry::CreateSource()
+{
+	ALuint id;
+
+	if (!m_d->idleSources.empty())
+	{
+		id = m_d->idleSources.back();
+		m_d->idleSources.pop_back();
+	}
+	else
+	{
+		// Running out of sources is expected under load, don't throw for it
+		alGetError();
+		alGenSources(1, &id);
+
+		if (alGetError() != AL_NO_ERROR)
+		{
+			return SoundSourceHandle{ invalidSoundHandleIndex, 0 };
+		}
+	}
+
+	auto key = m_d->sources.Insert(id);
+	return SoundSourceHandle{ key.index, key.generation };
+}
+
+bool SoundRegistry::DestroySource(SoundSourceHandle source)
+{
+	auto id = m_d->FindSource(source);
+
+	if (id == alInvalidId)
+	{
+		return false;
+	}
+
+	ResetSource(id);
+	m_d->idleSources.push_back(id);
+
+	return m_d->sources.Erase(ToKey(source));
+}
+
+bool SoundRegistry::IsValid(SoundSourceHandle source) const
+{
+	return m_d->FindSource(source) != alInvalidId;
+}
+
+bool SoundRegistry::SetBuffer(SoundSourceHandle source, SoundBufferHandle buffer)
+{
+	auto id = m_d->FindSource(source);
+
+	if (id == alInvalidId)
+	{
+		return false;
+	}
+
+	ALint bufferId = 0;
+
+	if (buffer.index != invalidSoundHandleIndex)
+	{
+		auto slot = m_d->buffers.Find(ToKey(buffer));
+
+		if (slot == nullptr)
+		{
+			return false;
+		}
+
+		bufferId = static_cast<ALint>(slot->id);
+	}
+
+	OpenAlCallVoid(alSourcei, id, static_cast<ALenum>(AL_BUFFER), bufferId);
+	return true;
+}
+
+bool SoundRegistry::Play(SoundSourceHandle source)
+{
+	auto id = m_d->FindSource(source);
+
+	if (id == alInvalidId)
+	{
+		return false;
+	}
+
+	OpenAlCallVoid(alSourcePlay, id);
+	return true;
+}
+
+bool SoundRegistry::Pause(SoundSourceHandle source)
+{
+	auto id = m_d->FindSource(source);
+
+	if (id == alInvalidId)
+	{
+		return false;
+	}
+
+	OpenAlCallVoid(alSourcePause, id);
+	return true;
+}
+
+bool SoundRegistry::Stop(SoundSourceHandle source)
+{
+	auto id = m_d->FindSource(source);
+
+	if (id == alInvalidId)
+	{
+		return false;
+	}
+
+	OpenAlCallVoid(alSourceStop, id);
+	return true;
+}
+
+bool SoundRegistry::SetLooping(SoundSourceHandle source, bool looping)
+{
+	auto id = m_d->FindSource(source);
+
+	if (id == alInvalidId)
+	{
+		return false;
+	}
+
+	OpenAlCallVoid(alSourcei,
+		id,
+		static_cast<ALenum>(AL_LOOPING),
+		static_cast<ALint>(looping ? AL_TRUE : AL_FALSE));
+	return true;
+}
+
+bool SoundRegistry::SetPosition(SoundSourceHandle source, float x, float y, float z)
+{
+	auto id = m_d->FindSource(source);
+
+	if (id == alInvalidId)
+	{
+		return false;
+	}
+
+	OpenAlCallVoid(alSource3f, id, static_cast<ALenum>(AL_POSITION), x, y, z);
+	return true;
+}
+
+bool SoundRegistry::SetVelocity(SoundSourceHandle source, float x, float y, float z)
+{
+	auto id = m_d->FindSource(source);
+
+	if (id == alInvalidId)
+	{
+		return false;
+	}
+
+	OpenAlCallVoid(alSource3f, id, static_cast<ALenum>(AL_VELOCITY), x, y, z);
+	return true;
+}
+
+bool SoundRegistry::SetGain(SoundSourceHandle source, float gain)
+{
+	auto id = m_d->FindSource(source);
+
+	if (id == alInvalidId)
+	{
+		return false;
+	}
+
+	OpenAlCallVoid(alSourcef, id, static_cast<ALenum>(AL_GAIN), gain);
+	return true;
+}
+
+bool SoundRegistry::SetPitch(SoundSourceHandle source, float pitch)
+{
+	auto id = m_d->FindSource(source);
+
+	if (id == alInvalidId)
+	{
+		return false;
+	}
+
+	OpenAlCallVoid(alSourcef, id, static_cast<ALenum>(AL_PITCH), pitch);
+	return true;
+}
+
+SoundSourceState SoundRegistry::GetState(SoundSourceHandle source) const
+{
+	auto id = m_d->FindSource(source);
+
+	if (id == alInvalidId)
+	{
+		return SoundSourceState::Stopped;
+	}
+
+	ALint state;
+	OpenAlCallVoid(alGetSourcei, id, static_cast<ALenum>(AL_SOURCE_STATE), &state);
+
+	return ToSoundSourceState(state);
+}
+
+void SoundRegistry::ApplyBatch(const SoundSourceHandle* sources, const SoundSourceBatch& batch)
+{
+	ApplySourceBatch(batch, [this, sources](size_t i)
+	{
+		return m_d->FindSource(sources[i]);
+	});
+}
+
+size_t SoundRegistry::GetSourcesCount() const
+{
+	return m_d->sources.GetSize();
+}
+
+size_t SoundRegistry::GetBuffersCount() const
+{
+	return m_d->buffers.GetSize();
+}
\ No newline at end of file
@@ -0,0 +1,844 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "MpscQueue.h"
+
+#include "SoundTools/AsyncWaveLoader.h"
+#include "SoundTools/SoundBatchLoader.h"
+#include "SoundTools/SoundBuffer.h"
+#include "SoundTools/SoundBufferCache.h"
+#include "SoundTools/SoundContext.h"
+#include "SoundTools/SoundDevice.h"
+#include "SoundTools/SoundServer.h"
+#include "SoundTools/SoundSource.h"
+#include "SoundTools/StreamingSoundSource.h"
+#include "SoundTools/WaveBuffer.h"
+
+namespace
+{
+	enum class CommandType
+	{
+		PlayFile,
+		// A file that wasn't cached has been read for PlayFile
+		PlayLoaded,
+		PlayWave,
+		PlayStream,
+		Preload,
+		Pause,
+		Resume,
+		Stop,
+		SetLooping,
+		SetGain,
+		SetPitch,
+		GetState,
+		Access,
+		Call
+	};
+
+	// Generated sounds are short-lived tones, small blocks keep their start latency low
+	constexpr size_t streamBlockSize = 16 * 1024;
+	constexpr size_t streamBuffersCount = 4;
+
+	// Preloaded buffers created per tick, so other commands aren't held up by a large batch
+	constexpr size_t preloadUploadsPerTick = 64;
+
+	struct Command
+	{
+		CommandType type;
+		uint64_t id;
+		float value;
+		std::string filename;
+		std::vector<std::string> filenames;
+		std::string error;
+		std::shared_ptr<const WaveBuffer> wave;
+		std::unique_ptr<SoundGenerator> generator;
+		SoundCompletionCallback onComplete;
+		std::unique_ptr<std::promise<SoundSourceState>> queried;
+		std::function<void(SoundSource&)> access;
+		std::unique_ptr<std::promise<bool>> accessed;
+		std::unique_ptr<std::promise<size_t>> preloaded;
+		std::function<void()> call;
+	};
+}
+
+class SoundServer::Impl
+{
+public:
+	struct Stream
+	{
+		Stream(StreamingSoundSource&& source, SoundCompletionCallback&& onComplete) :
+			source(std::move(source)),
+			onComplete(std::move(onComplete))
+		{}
+
+		StreamingSoundSource source;
+		SoundCompletionCallback onComplete;
+	};
+
+	// Files of one Preload call, they have consecutive loader indices
+	struct Preload
+	{
+		size_t first;
+		size_t count;
+		size_t handled;
+		size_t loaded;
+		std::promise<size_t> done;
+	};
+
+	// Objects that only exist on the server thread
+	struct State
+	{
+		State(const char* deviceName, const SoundContextConfig& contextConfig) :
+			device(deviceName),
+			context(&device, contextConfig),
+			lifecycle(std::chrono::milliseconds(0))
+		{
+			context.SetCurrent();
+		}
+
+		SoundDevice device;
+		SoundContext context;
+		SoundBufferCache bufferCache;
+		SoundLifecycleManager lifecycle;
+		// Client ids of playing sounds to the lifecycle manager ids
+		std::unordered_map<uint64_t, uint64_t> sounds;
+		// Refilled and polled every tick, there are only a few of them
+		std::unordered_map<uint64_t, Stream> streams;
+		// Commands for sounds whose files are being read, applied once they start
+		std::unordered_map<uint64_t, std::vector<Command>> loading;
+		// Exists while files are preloaded, its buffers are then only owned by the cache
+		std::unique_ptr<SoundBatchLoader> loader;
+		std::vector<Preload> preloads;
+	};
+
+	Impl(SoundServerErrorHandler onError, std::chrono::milliseconds tick) :
+		onError(std::move(onError)),
+		tick(tick),
+		nextId(1),
+		waiting(false),
+		exit(false)
+	{}
+
+	void Post(Command&& command)
+	{
+		commands.Push(std::move(command));
+
+		// Pairs with the fence in Run: either this sees the flag or the server sees the command.
+		// The mutex is only taken when the server thread is about to sleep
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiting.load(std::memory_order_relaxed))
+		{
+			std::lock_guard<std::mutex> guard(wakeMutex);
+			wakeUp.notify_one();
+		}
+	}
+
+	void Post(CommandType type, uint64_t id, float value = 0)
+	{
+		Command command;
+		command.type = type;
+		command.id = id;
+		command.value = value;
+		Post(std::move(command));
+	}
+
+	void ReportError(uint64_t id, const std::exception& ex) const
+	{
+		ReportError(id, ex.what());
+	}
+
+	void ReportError(uint64_t id, const char* message) const
+	{
+		if (onError)
+		{
+			onError(id, message);
+		}
+	}
+
+	static void StartSound(State& state, Command& command, std::shared_ptr<SoundBuffer> buffer)
+	{
+		SoundSource source;
+		source.SetBuffer(buffer.get());
+		source.SetLooping(command.value != 0);
+
+		auto sounds = &state.sounds;
+		auto id = command.id;
+		auto onComplete = std::move(command.onComplete);
+
+		uint64_t soundId;
+
+		try
+		{
+			soundId = state.lifecycle.Play(std::move(source), std::move(buffer),
+				[sounds, id, onComplete](uint64_t)
+			{
+				sounds->erase(id);
+
+				if (onComplete)
+				{
+					onComplete(id);
+				}
+			});
+		}
+		catch (...)
+		{
+			// Handed back, so the caller reports the error and completes the sound
+			command.onComplete = std::move(onComplete);
+			throw;
+		}
+
+		state.sounds[id] = soundId;
+	}
+
+	static void StartStream(State& state, Command& command)
+	{
+		// Refilled by the server tick, so all AL calls stay on the server thread
+		StreamingSoundSource source(std::move(command.generator), streamBlockSize, streamBuffersCount, false);
+		source.SetLooping(command.value != 0);
+		source.Play();
+
+		state.streams.emplace(command.id, Stream(std::move(source), std::move(command.onComplete)));
+	}
+
+	static void FinishStream(State& state, std::unordered_map<uint64_t, Stream>::iterator it)
+	{
+		auto id = it->first;
+		auto onComplete = std::move(it->second.onComplete);
+		state.streams.erase(it);
+
+		if (onComplete)
+		{
+			onComplete(id);
+		}
+	}
+
+	static void ExecuteOnStream(State& state, Command& command, std::unordered_map<uint64_t, Stream>::iterator it)
+	{
+		auto& source = it->second.source;
+
+		switch (command.type)
+		{
+		case CommandType::Pause:
+			source.Pause();
+			break;
+		case CommandType::Resume:
+			source.Play();
+			break;
+		case CommandType::Stop:
+			source.Stop();
+			FinishStream(state, it);
+			break;
+		case CommandType::SetLooping:
+			source.SetLooping(command.value != 0);
+			break;
+		case CommandType::SetGain:
+			source.SetGain(command.value);
+			break;
+		case CommandType::SetPitch:
+			source.SetPitch(command.value);
+			break;
+		case CommandType::GetState:
+			command.queried->set_value(source.GetState());
+			break;
+		case CommandType::Access:
+			// Streams have no SoundSource to hand out
+			command.accessed->set_value(false);
+			break;
+		default:
+			break;
+		}
+	}
+
+	void UpdateStreams(State& state) const
+	{
+		for (auto it = state.streams.begin(); it != state.streams.end();)
+		{
+			auto next = std::next(it);
+
+			try
+			{
+				it->second.source.Update();
+			}
+			catch (const std::exception& ex)
+			{
+				// The stream is stopped, it completes below
+				ReportError(it->first, ex);
+			}
+
+			if (it->second.source.GetState() == SoundSourceState::Stopped)
+			{
+				FinishStream(state, it);
+			}
+
+			it = next;
+		}
+	}
+
+	// The file is read on the loader threads, so a cold file doesn't hold up other commands
+	void LoadFile(State& state, Command& command)
+	{
+		state.loading[command.id];
+
+		auto pending = std::make_shared<Command>(std::move(command));
+		loader.Load(pending->filename.c_str(), [this, pending](std::unique_ptr<WaveBuffer> wave, const char* error)
+		{
+			pending->type = CommandType::PlayLoaded;
+			pending->wave = std::move(wave);
+			pending->error = error != nullptr ? error : "";
+			Post(std::move(*pending));
+		});
+	}
+
+	void FinishLoad(State& state, Command& command)
+	{
+		auto it = state.loading.find(command.id);
+		auto deferred = std::move(it->second);
+		state.loading.erase(it);
+
+		auto stopped = std::any_of(deferred.begin(), deferred.end(), [](const Command& deferredCommand)
+		{
+			return deferredCommand.type == CommandType::Stop;
+		});
+
+		try
+		{
+			if (command.wave == nullptr)
+			{
+				throw std::runtime_error(command.error);
+			}
+
+			if (stopped)
+			{
+				if (command.onComplete)
+				{
+					command.onComplete(command.id);
+				}
+			}
+			else
+			{
+				auto buffer = std::make_shared<SoundBuffer>(command.wave->MakeSoundBuffer());
+				state.bufferCache.Insert(command.filename.c_str(), buffer);
+				StartSound(state, command, std::move(buffer));
+			}
+		}
+		catch (const std::exception& ex)
+		{
+			ReportError(command.id, ex);
+
+			if (command.onComplete)
+			{
+				command.onComplete(command.id);
+			}
+		}
+
+		// In posting order, as if the sound had started right away
+		for (auto& deferredCommand : deferred)
+		{
+			ExecuteSafe(state, deferredCommand);
+		}
+	}
+
+	static void StartPreload(State& state, Command& command)
+	{
+		if (command.filenames.empty())
+		{
+			command.preloaded->set_value(0);
+			return;
+		}
+
+		if (state.loader == nullptr)
+		{
+			state.loader = std::make_unique<SoundBatchLoader>();
+		}
+
+		std::vector<const char*> filenames;
+		for (auto& filename : command.filenames)
+		{
+			filenames.push_back(filename.c_str());
+		}
+
+		Preload preload;
+		preload.first = state.loader->Load(filenames.data(), filenames.size());
+		preload.count = filenames.size();
+		preload.handled = 0;
+		preload.loaded = 0;
+		preload.done = std::move(*command.preloaded);
+		state.preloads.push_back(std::move(preload));
+	}
+
+	void UploadPreloaded(State& state) const
+	{
+		if (state.loader == nullptr)
+		{
+			return;
+		}
+
+		auto& loader = *state.loader;
+
+		loader.Upload(preloadUploadsPerTick, [&](size_t index)
+		{
+			auto preload = std::find_if(state.preloads.begin(), state.preloads.end(), [index](const Preload& entry)
+			{
+				return index >= entry.first && index < entry.first + entry.count;
+			});
+
+			auto buffer = loader.GetBuffer(index);
+
+			if (buffer != nullptr)
+			{
+				state.bufferCache.Insert(loader.GetFilename(index), std::move(buffer));
+				++preload->loaded;
+			}
+			else
+			{
+				ReportError(0, loader.GetError(index));
+			}
+
+			if (++preload->handled == preload->count)
+			{
+				preload->done.set_value(preload->loaded);
+				state.preloads.erase(preload);
+			}
+		});
+
+		if (loader.IsDone())
+		{
+			state.loader.reset();
+		}
+	}
+
+	void Execute(State& state, Command& command)
+	{
+		switch (command.type)
+		{
+		case CommandType::PlayFile:
+		{
+			auto buffer = state.bufferCache.Find(command.filename.c_str());
+
+			if (buffer != nullptr)
+			{
+				StartSound(state, command, std::move(buffer));
+			}
+			else
+			{
+				LoadFile(state, command);
+			}
+
+			return;
+		}
+
+		case CommandType::PlayLoaded:
+			FinishLoad(state, command);
+			return;
+
+		case CommandType::PlayWave:
+			StartSound(state, command, std::make_shared<SoundBuffer>(command.wave->MakeSoundBuffer()));
+			return;
+
+		case CommandType::PlayStream:
+			StartStream(state, command);
+			return;
+
+		case CommandType::Preload:
+			StartPreload(state, command);
+			return;
+
+		case CommandType::Call:
+			command.call();
+			return;
+
+		default:
+			break;
+		}
+
+		auto loading = state.loading.find(command.id);
+
+		if (loading != state.loading.end())
+		{
+			loading->second.push_back(std::move(command));
+			return;
+		}
+
+		auto stream = state.streams.find(command.id);
+
+		if (stream != state.streams.end())
+		{
+			ExecuteOnStream(state, command, stream);
+			return;
+		}
+
+		auto it = state.sounds.find(command.id);
+
+		if (it == state.sounds.end())
+		{
+			if (command.type == CommandType::Access)
+			{
+				command.accessed->set_value(false);
+			}
+			else if (command.type == CommandType::GetState)
+			{
+				command.queried->set_value(SoundSourceState::Stopped);
+			}
+
+			return;
+		}
+
+		auto lifecycleId = it->second;
+
+		if (command.type == CommandType::Stop)
+		{
+			state.lifecycle.Stop(lifecycleId);
+			return;
+		}
+
+		auto found = state.lifecycle.Access(lifecycleId, [&command](SoundSource& source)
+		{
+			switch (command.type)
+			{
+			case CommandType::Pause:
+				source.Pause();
+				break;
+			case CommandType::Resume:
+				source.Play();
+				break;
+			case CommandType::SetLooping:
+				source.SetLooping(command.value != 0);
+				break;
+			case CommandType::SetGain:
+				source.SetGain(command.value);
+				break;
+			case CommandType::SetPitch:
+				source.SetPitch(command.value);
+				break;
+			case CommandType::GetState:
+				command.queried->set_value(source.GetState());
+				break;
+			case CommandType::Access:
+				command.access(source);
+				break;
+			default:
+				break;
+			}
+		});
+
+		if (command.type == CommandType::Access)
+		{
+			command.accessed->set_value(found);
+		}
+		else if (command.type == CommandType::GetState && !found)
+		{
+			command.queried->set_value(SoundSourceState::Stopped);
+		}
+	}
+
+	void ExecuteSafe(State& state, Command& command)
+	{
+		try
+		{
+			Execute(state, command);
+		}
+		catch (const std::exception& ex)
+		{
+			ReportError(command.id, ex);
+
+			// Don't leave clients waiting for a sound that never started
+			if (command.onComplete)
+			{
+				command.onComplete(command.id);
+			}
+
+			try
+			{
+				if (command.accessed != nullptr)
+				{
+					command.accessed->set_exception(std::current_exception());
+				}
+
+				if (command.queried != nullptr)
+				{
+					command.queried->set_exception(std::current_exception());
+				}
+
+				if (command.preloaded != nullptr)
+				{
+					command.preloaded->set_exception(std::current_exception());
+				}
+			}
+			catch (const std::future_error&)
+			{
+			}
+		}
+	}
+
+	void Drain(State& state)
+	{
+		Command command;
+
+		while (commands.Pop(command))
+		{
+			ExecuteSafe(state, command);
+		}
+	}
+
+	void Run(const char* deviceName, const SoundContextConfig& contextConfig, std::promise<void>& started)
+	{
+		std::unique_ptr<State> state;
+
+		try
+		{
+			state = std::make_unique<State>(deviceName, contextConfig);
+		}
+		catch (...)
+		{
+			started.set_exception(std::current_exception());
+			return;
+		}
+
+		started.set_value();
+
+		while (true)
+		{
+			Drain(*state);
+
+			try
+			{
+				state->lifecycle.Update();
+				UpdateStreams(*state);
+				UploadPreloaded(*state);
+				state->context.CheckErrors();
+			}
+			catch (const std::exception& ex)
+			{
+				ReportError(0, ex);
+			}
+
+			std::unique_lock<std::mutex> lock(wakeMutex);
+
+			if (exit)
+			{
+				break;
+			}
+
+			waiting.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			wakeUp.wait_for(lock, tick, [this]() { return exit || !commands.IsEmpty(); });
+			waiting.store(false);
+		}
+	}
+
+	SoundServerErrorHandler onError;
+	std::chrono::milliseconds tick;
+	std::atomic<uint64_t> nextId;
+	MpscQueue<Command> commands;
+	std::atomic<bool> waiting;
+	bool exit;
+	std::mutex wakeMutex;
+	std::condition_variable wakeUp;
+	std::thread thread;
+	// Declared last, its callbacks post to the members above
+	AsyncWaveLoader loader;
+};
+
+SoundServer::SoundServer(
+	const char* deviceName,
+	SoundServerErrorHandler onError,
+	std::chrono::milliseconds tick,
+	const SoundContextConfig& contextConfig) :
+	m_d(std::make_unique<Impl>(std::move(onError), tick))
+{
+	std::promise<void> started;
+
+	// deviceName and contextConfig are only read before the thread reports that it has started
+	m_d->thread = std::thread([this, deviceName, &contextConfig, &started]()
+	{
+		m_d->Run(deviceName, contextConfig, started);
+	});
+
+	try
+	{
+		started.get_future().get();
+	}
+	catch (...)
+	{
+		m_d->thread.join();
+		throw;
+	}
+}
+
+SoundServer::~SoundServer()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_d->wakeMutex);
+		m_d->exit = true;
+	}
+
+	m_d->wakeUp.notify_one();
+	m_d->thread.join();
+}
+
+uint64_t SoundServer::Play(
+	const char* filename,
+	bool looping,
+	SoundCompletionCallback onComplete)
+{
+	if (filename == nullptr)
+	{
+		throw std::invalid_argument("File name can't be null");
+	}
+
+	Command command;
+	command.type = CommandType::PlayFile;
+	command.id = m_d->nextId++;
+	command.value = looping ? 1.f : 0.f;
+	command.filename = filename;
+	command.onComplete = std::move(onComplete);
+
+	auto id = command.id;
+	m_d->Post(std::move(command));
+
+	return id;
+}
+
+uint64_t SoundServer::Play(
+	std::shared_ptr<const WaveBuffer> wave,
+	bool looping,
+	SoundCompletionCallback onComplete)
+{
+	if (wave == nullptr)
+	{
+		throw std::invalid_argument("Wave buffer can't be null");
+	}
+
+	Command command;
+	command.type = CommandType::PlayWave;
+	command.id = m_d->nextId++;
+	command.value = looping ? 1.f : 0.f;
+	command.wave = std::move(wave);
+	command.onComplete = std::move(onComplete);
+
+	auto id = command.id;
+	m_d->Post(std::move(command));
+
+	return id;
+}
+
+uint64_t SoundServer::Play(
+	std::unique_ptr<SoundGenerator> generator,
+	bool looping,
+	SoundCompletionCallback onComplete)
+{
+	if (generator == nullptr)
+	{
+		throw std::invalid_argument("Generator can't be null");
+	}
+
+	Command command;
+	command.type = CommandType::PlayStream;
+	command.id = m_d->nextId++;
+	command.value = looping ? 1.f : 0.f;
+	command.generator = std::move(generator);
+	command.onComplete = std::move(onComplete);
+
+	auto id = command.id;
+	m_d->Post(std::move(command));
+
+	return id;
+}
+
+std::future<size_t> SoundServer::Preload(const char* const* filenames, size_t count)
+{
+	Command command;
+	command.type = CommandType::Preload;
+	command.id = 0;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (filenames[i] == nullptr)
+		{
+			throw std::invalid_argument("File name can't be null");
+		}
+
+		command.filenames.push_back(filenames[i]);
+	}
+
+	command.preloaded = std::make_unique<std::promise<size_t>>();
+
+	auto result = command.preloaded->get_future();
+	m_d->Post(std::move(command));
+
+	return result;
+}
+
+void SoundServer::Pause(uint64_t id)
+{
+	m_d->Post(CommandType::Pause, id);
+}
+
+void SoundServer::Resume(uint64_t id)
+{
+	m_d->Post(CommandType::Resume, id);
+}
+
+void SoundServer::Stop(uint64_t id)
+{
+	m_d->Post(CommandType::Stop, id);
+}
+
+void SoundServer::SetLooping(uint64_t id, bool looping)
+{
+	m_d->Post(CommandType::SetLooping, id, looping ? 1.f : 0.f);
+}
+
+void SoundServer::SetGain(uint64_t id, float gain)
+{
+	m_d->Post(CommandType::SetGain, id, gain);
+}
+
+void SoundServer::SetPitch(uint64_t id, float pitch)
+{
+	m_d->Post(CommandType::SetPitch, id, pitch);
+}
+
+std::future<SoundSourceState> SoundServer::GetState(uint64_t id)
+{
+	Command command;
+	command.type = CommandType::GetState;
+	command.id = id;
+	command.queried = std::make_unique<std::promise<SoundSourceState>>();
+
+	auto result = command.queried->get_future();
+	m_d->Post(std::move(command));
+
+	return result;
+}
+
+std::future<bool> SoundServer::Access(uint64_t id, std::function<void(SoundSource&)> fn)
+{
+	Command command;
+	command.type = CommandType::Access;
+	command.id = id;
+	command.access = std::move(fn);
+	command.accessed = std::make_unique<std::promise<bool>>();
+
+	auto result = command.accessed->get_future();
+	m_d->Post(std::move(command));
+
+	return result;
+}
+
+void SoundServer::Post(std::function<void()> fn)
+{
+	Command command;
+	command.type = CommandType::Call;
+	command.id = 0;
+	command.call = std::move(fn);
+	m_d->Post(std::move(command));
+}
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "OpenAlTools.h"
+#include "SourceBatch.h"
+#include "SourceState.h"
 #include "SoundTools/SoundBuffer.h"
 #include "SoundTools/SoundSource.h"
 
@@ -37,7 +39,7 @@ public:
 SoundSource::SoundSource() :
 	m_d(std::make_unique<Impl>())
 {
-	OpenAlCallVoid(alGenSources, 1, &m_d->sourceId);
+	OpenAlCallVoidStrict(alGenSources, 1, &m_d->sourceId);
 	alSourcef(m_d->sourceId, AL_PITCH, 1);
 	alSourcef(m_d->sourceId, AL_GAIN, 1);
 	alSource3f(m_d->sourceId, AL_POSITION, 0, 0, 0);
@@ -50,13 +52,19 @@ SoundSource::~SoundSource() = default;
 SoundSource& SoundSource::operator=(SoundSource&&) = default;
 
 
+size_t SoundSource::GetId() const
+{
+	m_d->Check();
+	return m_d->sourceId;
+}
+
 void SoundSource::SetBuffer(SoundBuffer* buffer)
 {
 	m_d->Check();
 	OpenAlCallVoid(alSourcei,
 		m_d->sourceId,
 		(ALenum)AL_BUFFER,
-		(ALint)buffer->GetId());
+		buffer != nullptr ? (ALint)buffer->GetId() : 0);
 }
 
 void SoundSource::Pause() const
@@ -87,15 +95,7 @@ SoundSourceState SoundSource::GetState() const
 		static_cast<ALenum>(AL_SOURCE_STATE),
 		&result);
 
-	switch (result)
-	{
-		case AL_INITIAL: return SoundSourceState::Initial;
-		case AL_PLAYING: return SoundSourceState::Playing;
-		case AL_PAUSED:  return SoundSourceState::Paused;
-		case AL_STOPPED: return SoundSourceState::Stopped;
-	}
-	
-	throw std::runtime_error("Unexpected sound source state");
+	return ToSoundSourceState(result);
 }
 
 void SoundSource::SetLooping(bool looping)
@@ -117,4 +117,57 @@ bool SoundSource::GetLooping() const
 		static_cast<ALenum>(AL_LOOPING), &result);
 
 	return result == 0 ? false : true;
+}
+
+void SoundSource::SetPosition(float x, float y, float z)
+{
+	m_d->Check();
+	OpenAlCallVoid(alSource3f, m_d->sourceId, static_cast<ALenum>(AL_POSITION), x, y, z);
+}
+
+void SoundSource::SetVelocity(float x, float y, float z)
+{
+	m_d->Check();
+	OpenAlCallVoid(alSource3f, m_d->sourceId, static_cast<ALenum>(AL_VELOCITY), x, y, z);
+}
+
+void SoundSource::SetGain(float gain)
+{
+	m_d->Check();
+	OpenAlCallVoid(alSourcef, m_d->sourceId, static_cast<ALenum>(AL_GAIN), gain);
+}
+
+float SoundSource::GetGain() const
+{
+	m_d->Check();
+
+	ALfloat result;
+	OpenAlCallVoid(alGetSourcef, m_d->sourceId, static_cast<ALenum>(AL_GAIN), &result);
+
+	return result;
+}
+
+void SoundSource::SetPitch(float pitch)
+{
+	m_d->Check();
+	OpenAlCallVoid(alSourcef, m_d->sourceId, static_cast<ALenum>(AL_PITCH), pitch);
+}
+
+float SoundSource::GetPitch() const
+{
+	m_d->Check();
+
+	ALfloat result;
+	OpenAlCallVoid(alGetSourcef, m_d->sourceId, static_cast<ALenum>(AL_PITCH), &result);
+
+	return result;
+}
+
+void SoundSource::ApplyBatch(SoundSource* const* sources, const SoundSourceBatch& batch)
+{
+	ApplySourceBatch(batch, [sources](size_t i)
+	{
+		auto source = sources[i];
+		return source != nullptr && source->m_d->IdIsValid() ? source->m_d->sourceId : alInvalidId;
+	});
 }
\ No newline at end of file
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "OpenAlTools.h"
+
+#include "SoundTools/SoundContext.h"
+#include "SoundTools/SoundSource.h"
+#include "SoundTools/SoundSourcePool.h"
+
+namespace
+{
+	constexpr auto invalidVoiceIndex = std::numeric_limits<uint32_t>::max();
+
+	size_t GetContextSourcesLimit(const SoundContext& context)
+	{
+		auto capabilities = context.GetCapabilities();
+
+		// Not every implementation reports limits, OpenAL Soft defaults to 256 sources
+		auto sourcesCount = capabilities.monoSourcesCount + capabilities.stereoSourcesCount;
+		return sourcesCount > 0 ? sourcesCount : 256;
+	}
+}
+
+class SoundSourcePool::Impl
+{
+public:
+	struct Slot
+	{
+		Slot(SoundSource&& source) :
+			source(std::move(source)),
+			generation(0),
+			priority(0),
+			active(false)
+		{}
+
+		SoundSource source;
+		uint32_t generation;
+		int priority;
+		bool active;
+	};
+
+	void Allocate(size_t sourcesCount)
+	{
+		if (sourcesCount == 0)
+		{
+			throw std::invalid_argument("Source pool can't be empty");
+		}
+
+		slots.reserve(sourcesCount);
+
+		// Drivers may report more sources than they actually hand out
+		try
+		{
+			while (slots.size() < sourcesCount)
+			{
+				slots.emplace_back(SoundSource());
+			}
+		}
+		catch (const std::exception&)
+		{
+			if (slots.empty())
+			{
+				throw;
+			}
+		}
+
+		// Popped from the back, so the first slots are handed out first
+		for (auto i = slots.size(); i > 0; --i)
+		{
+			freeSlots.push_back(static_cast<uint32_t>(i - 1));
+		}
+	}
+
+	const Slot* Find(SoundVoice voice) const
+	{
+		if (voice.index >= slots.size())
+		{
+			return nullptr;
+		}
+
+		auto& slot = slots[voice.index];
+		return slot.active && slot.generation == voice.generation ? &slot : nullptr;
+	}
+
+	void Recycle(size_t index)
+	{
+		auto& slot = slots[index];
+		auto id = static_cast<ALuint>(slot.source.GetId());
+
+		// Put the source back into the state SoundSource construction leaves it in.
+		// Rewinding leaves it AL_INITIAL, only a voice that played to the end is AL_STOPPED.
+		alSourceRewind(id);
+		alSourcei(id, AL_BUFFER, 0);
+		alSourcef(id, AL_PITCH, 1);
+		alSourcef(id, AL_GAIN, 1);
+		alSource3f(id, AL_POSITION, 0, 0, 0);
+		alSource3f(id, AL_VELOCITY, 0, 0, 0);
+		alSourcei(id, AL_LOOPING, AL_FALSE);
+
+		slot.active = false;
+		++slot.generation;
+		freeSlots.push_back(static_cast<uint32_t>(index));
+	}
+
+	// Frees every voice that played to the end, one state query per voice
+	void ReclaimStopped()
+	{
+		for (size_t i = 0; i < slots.size(); ++i)
+		{
+			if (!slots[i].active)
+			{
+				continue;
+			}
+
+			ALint state;
+			OpenAlCallVoid(alGetSourcei,
+				static_cast<ALuint>(slots[i].source.GetId()),
+				static_cast<ALenum>(AL_SOURCE_STATE),
+				&state);
+
+			// Acquired voices that haven't been played yet stay AL_INITIAL and are kept
+			if (state == AL_STOPPED)
+			{
+				Recycle(i);
+			}
+		}
+	}
+
+	SoundVoice TakeFree(int priority)
+	{
+		auto index = freeSlots.back();
+		freeSlots.pop_back();
+
+		auto& slot = slots[index];
+		slot.active = true;
+		slot.priority = priority;
+
+		return SoundVoice{ index, slot.generation };
+	}
+
+	std::vector<Slot> slots;
+	// Inactive slots, so acquiring makes no OpenAL calls while there are any
+	std::vector<uint32_t> freeSlots;
+	mutable std::mutex mutex;
+};
+
+SoundSourcePool::SoundSourcePool(const SoundContext& context) :
+	SoundSourcePool(GetContextSourcesLimit(context))
+{
+}
+
+SoundSourcePool::SoundSourcePool(size_t sourcesCount) :
+	m_d(std::make_unique<Impl>())
+{
+	m_d->Allocate(sourcesCount);
+}
+
+SoundSourcePool::~SoundSourcePool() = default;
+
+SoundVoice SoundSourcePool::Acquire(int priority)
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+
+	// Finished voices are only looked for once the released ones run out
+	if (m_d->freeSlots.empty())
+	{
+		m_d->ReclaimStopped();
+	}
+
+	if (!m_d->freeSlots.empty())
+	{
+		return m_d->TakeFree(priority);
+	}
+
+	// Every voice is busy: priorities are compared first, gains are only queried for the least important ones
+	auto lowest = std::numeric_limits<int>::max();
+	for (auto& slot : m_d->slots)
+	{
+		lowest = std::min(lowest, slot.priority);
+	}
+
+	if (lowest > priority)
+	{
+		return SoundVoice{ invalidVoiceIndex, 0 };
+	}
+
+	size_t victimIndex = 0;
+	ALfloat victimGain = 0;
+	bool found = false;
+
+	for (size_t i = 0; i < m_d->slots.size(); ++i)
+	{
+		auto& slot = m_d->slots[i];
+
+		if (slot.priority != lowest)
+		{
+			continue;
+		}
+
+		ALfloat gain;
+		OpenAlCallVoid(alGetSourcef,
+			static_cast<ALuint>(slot.source.GetId()),
+			static_cast<ALenum>(AL_GAIN),
+			&gain);
+
+		if (!found || gain < victimGain)
+		{
+			victimIndex = i;
+			victimGain = gain;
+			found = true;
+		}
+	}
+
+	m_d->Recycle(victimIndex);
+	return m_d->TakeFree(priority);
+}
+
+void SoundSourcePool::Release(SoundVoice voice)
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+
+	if (m_d->Find(voice) != nullptr)
+	{
+		m_d->Recycle(voice.index);
+	}
+}
+
+bool SoundSourcePool::IsValid(SoundVoice voice) const
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	return m_d->Find(voice) != nullptr;
+}
+
+SoundSource* SoundSourcePool::GetSource(SoundVoice voice) const
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	auto slot = m_d->Find(voice);
+	return slot != nullptr ? const_cast<SoundSource*>(&slot->source) : nullptr;
+}
+
+size_t SoundSourcePool::GetCapacity() const
+{
+	return m_d->slots.size();
+}
+
+size_t SoundSourcePool::GetActiveCount() const
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	return m_d->slots.size() - m_d->freeSlots.size();
+}
\ No newline at end of file
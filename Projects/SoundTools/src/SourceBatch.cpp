@@ -0,0 +1,76 @@
+#include "SourceBatch.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+	struct DeferredUpdatesFunctions
+	{
+		LPALDEFERUPDATESSOFT deferUpdates;
+		LPALPROCESSUPDATESSOFT processUpdates;
+	};
+
+	DeferredUpdatesFunctions LoadDeferredUpdatesFunctions()
+	{
+		DeferredUpdatesFunctions result = { nullptr, nullptr };
+
+		if (alIsExtensionPresent("AL_SOFT_deferred_updates"))
+		{
+			result.deferUpdates = reinterpret_cast<LPALDEFERUPDATESSOFT>(alGetProcAddress("alDeferUpdatesSOFT"));
+			result.processUpdates = reinterpret_cast<LPALPROCESSUPDATESSOFT>(alGetProcAddress("alProcessUpdatesSOFT"));
+		}
+
+		return result;
+	}
+
+	// Looked up for each context, a router may hand contexts of different drivers
+	std::mutex deferredUpdatesMutex;
+	std::unordered_map<ALCcontext*, DeferredUpdatesFunctions> deferredUpdatesByContext;
+
+	DeferredUpdatesFunctions GetDeferredUpdatesFunctions()
+	{
+		auto context = alcGetCurrentContext();
+
+		if (context == nullptr)
+		{
+			return DeferredUpdatesFunctions{ nullptr, nullptr };
+		}
+
+		std::lock_guard<std::mutex> guard(deferredUpdatesMutex);
+		auto it = deferredUpdatesByContext.find(context);
+
+		if (it == deferredUpdatesByContext.end())
+		{
+			it = deferredUpdatesByContext.emplace(context, LoadDeferredUpdatesFunctions()).first;
+		}
+
+		return it->second;
+	}
+}
+
+void ForgetDeferredUpdates(ALCcontext* context)
+{
+	std::lock_guard<std::mutex> guard(deferredUpdatesMutex);
+	deferredUpdatesByContext.erase(context);
+}
+
+ScopedDeferredUpdates::ScopedDeferredUpdates() :
+	m_processUpdates(nullptr)
+{
+	auto functions = GetDeferredUpdatesFunctions();
+
+	if (functions.deferUpdates != nullptr && functions.processUpdates != nullptr)
+	{
+		functions.deferUpdates();
+		m_processUpdates = functions.processUpdates;
+	}
+}
+
+ScopedDeferredUpdates::~ScopedDeferredUpdates()
+{
+	if (m_processUpdates != nullptr)
+	{
+		m_processUpdates();
+	}
+}
\ No newline at end of file
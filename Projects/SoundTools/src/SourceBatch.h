@@ -0,0 +1,76 @@
+#pragma once
+
+#include <AL/alext.h>
+
+#include "OpenAlTools.h"
+
+#include "SoundTools/SoundSourceBatch.h"
+
+// Drops the deferred updates entry points looked up for a context about to be destroyed,
+// so a new context at the same address looks them up again
+void ForgetDeferredUpdates(ALCcontext* context);
+
+// Holds back mixing of source changes on the current context until destruction,
+// so the whole batch is heard at once. Without AL_SOFT_deferred_updates changes apply one by one.
+class ScopedDeferredUpdates
+{
+public:
+	ScopedDeferredUpdates();
+	ScopedDeferredUpdates(const ScopedDeferredUpdates&) = delete;
+	~ScopedDeferredUpdates();
+
+	ScopedDeferredUpdates& operator=(const ScopedDeferredUpdates&) = delete;
+
+private:
+	LPALPROCESSUPDATESSOFT m_processUpdates;
+};
+
+// Applies the batch to the sources getSource returns for each element.
+// getSource returns alInvalidId for elements that have to be skipped.
+template<typename GetSource>
+void ApplySourceBatch(const SoundSourceBatch& batch, GetSource&& getSource)
+{
+	ScopedDeferredUpdates deferred;
+
+	for (size_t i = 0; i < batch.count; ++i)
+	{
+		ALuint id = getSource(i);
+
+		if (id == alInvalidId)
+		{
+			continue;
+		}
+
+		if (batch.positionX != nullptr)
+		{
+			OpenAlInvokeVoid<OpenAlBatchCheckPolicy>(
+				OpenAlCallSite{ __FILE__, __LINE__, "alSource3f" },
+				alSource3f, id, static_cast<ALenum>(AL_POSITION),
+				batch.positionX[i], batch.positionY[i], batch.positionZ[i]);
+		}
+
+		if (batch.velocityX != nullptr)
+		{
+			OpenAlInvokeVoid<OpenAlBatchCheckPolicy>(
+				OpenAlCallSite{ __FILE__, __LINE__, "alSource3f" },
+				alSource3f, id, static_cast<ALenum>(AL_VELOCITY),
+				batch.velocityX[i], batch.velocityY[i], batch.velocityZ[i]);
+		}
+
+		if (batch.gain != nullptr)
+		{
+			OpenAlInvokeVoid<OpenAlBatchCheckPolicy>(
+				OpenAlCallSite{ __FILE__, __LINE__, "alSourcef" },
+				alSourcef, id, static_cast<ALenum>(AL_GAIN), batch.gain[i]);
+		}
+
+		if (batch.pitch != nullptr)
+		{
+			OpenAlInvokeVoid<OpenAlBatchCheckPolicy>(
+				OpenAlCallSite{ __FILE__, __LINE__, "alSourcef" },
+				alSourcef, id, static_cast<ALenum>(AL_PITCH), batch.pitch[i]);
+		}
+	}
+
+	OpenAlBatchCheckPolicy::Flush();
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdexcept>
+
+#include <AL/al.h>
+
+#include "SoundTools/SoundSource.h"
+
+inline SoundSourceState ToSoundSourceState(ALint state)
+{
+	switch (state)
+	{
+		case AL_INITIAL: return SoundSourceState::Initial;
+		case AL_PLAYING: return SoundSourceState::Playing;
+		case AL_PAUSED:  return SoundSourceState::Paused;
+		case AL_STOPPED: return SoundSourceState::Stopped;
+	}
+
+	throw std::runtime_error("Unexpected sound source state");
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Single-producer single-consumer ring of fixed-size frames. Neither side locks or allocates,
+// each one only publishes its own position. Free and filled ranges are handed out as at most
+// two contiguous spans, so frames are copied straight in and out of the ring.
+class SpscRing
+{
+public:
+	struct Span
+	{
+		uint8_t* data;
+		size_t framesCount;
+	};
+
+	// The capacity is rounded up to a power of two
+	SpscRing(size_t frameSize, size_t capacity) :
+		m_frameSize(frameSize),
+		m_capacity(1),
+		m_writePosition(0),
+		m_readPosition(0)
+	{
+		while (m_capacity < capacity)
+		{
+			m_capacity *= 2;
+		}
+
+		m_frames.reset(new uint8_t[m_capacity * m_frameSize]);
+	}
+
+	SpscRing(const SpscRing&) = delete;
+
+	size_t GetFrameSize() const
+	{
+		return m_frameSize;
+	}
+
+	size_t GetCapacity() const
+	{
+		return m_capacity;
+	}
+
+	// Producer only
+	size_t GetWritable() const
+	{
+		auto read = m_readPosition.load(std::memory_order_acquire);
+		return m_capacity - (m_writePosition.load(std::memory_order_relaxed) - read);
+	}
+
+	// Consumer only
+	size_t GetReadable() const
+	{
+		auto written = m_writePosition.load(std::memory_order_acquire);
+		return written - m_readPosition.load(std::memory_order_relaxed);
+	}
+
+	// Free space for up to framesCount frames, the second span is empty unless the range wraps
+	void GetWriteSpans(size_t framesCount, Span spans[2])
+	{
+		auto count = framesCount < GetWritable() ? framesCount : GetWritable();
+		GetSpans(m_writePosition.load(std::memory_order_relaxed), count, spans);
+	}
+
+	// Publishes frames written to the write spans
+	void CommitWrite(size_t framesCount)
+	{
+		m_writePosition.store(m_writePosition.load(std::memory_order_relaxed) + framesCount, std::memory_order_release);
+	}
+
+	void GetReadSpans(size_t framesCount, Span spans[2])
+	{
+		auto count = framesCount < GetReadable() ? framesCount : GetReadable();
+		GetSpans(m_readPosition.load(std::memory_order_relaxed), count, spans);
+	}
+
+	// Hands the read frames back to the producer
+	void CommitRead(size_t framesCount)
+	{
+		m_readPosition.store(m_readPosition.load(std::memory_order_relaxed) + framesCount, std::memory_order_release);
+	}
+
+	SpscRing& operator=(const SpscRing&) = delete;
+
+private:
+	void GetSpans(size_t position, size_t count, Span spans[2]) const
+	{
+		// Positions only grow, wrapping of size_t is harmless with a power of two capacity
+		auto offset = position & (m_capacity - 1);
+		auto first = count < m_capacity - offset ? count : m_capacity - offset;
+
+		spans[0].data = m_frames.get() + offset * m_frameSize;
+		spans[0].framesCount = first;
+		spans[1].data = m_frames.get();
+		spans[1].framesCount = count - first;
+	}
+
+	size_t m_frameSize;
+	size_t m_capacity;
+	std::unique_ptr<uint8_t[]> m_frames;
+
+	// Kept on separate cache lines, each is written by one side only
+	char m_writePadding[64];
+	std::atomic<size_t> m_writePosition;
+	char m_readPadding[64];
+	std::atomic<size_t> m_readPosition;
+};
\ No newline at end of file
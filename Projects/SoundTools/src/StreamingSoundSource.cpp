@@ -0,0 +1,493 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Adpcm.h"
+#include "AlFormat.h"
+#include "OpenAlTools.h"
+#include "SampleConversion.h"
+#include "SourceState.h"
+#include "WaveFile.h"
+
+#include "SoundTools/StreamingSoundSource.h"
+
+namespace
+{
+	// Reads the data chunk of a wave file
+	class WaveFileGenerator : public SoundGenerator
+	{
+	public:
+		WaveFileGenerator(const char* filename) :
+			m_file(filename, std::ios::binary),
+			m_position(0)
+		{
+			if (!m_file.is_open())
+			{
+				throw std::invalid_argument("Failed to open the file");
+			}
+
+			auto header = ReadWaveFileHeader(m_file);
+			m_format.channelsCount = header.format.numChannels;
+			m_format.bitsPerSample = header.format.bitsPerSample;
+			m_format.sampleRate = header.format.sampleRate;
+			m_format.encoding = header.encoding;
+			m_dataOffset = static_cast<std::streamoff>(header.dataOffset);
+			m_dataSize = header.dataSize;
+		}
+
+		SoundRenderFormat GetFormat() const override
+		{
+			return m_format;
+		}
+
+		void Rewind() override
+		{
+			m_file.clear();
+			m_file.seekg(m_dataOffset);
+			m_position = 0;
+		}
+
+		size_t Generate(void* data, size_t size) override
+		{
+			auto count = static_cast<size_t>(std::min<uint64_t>(size, m_dataSize - m_position));
+			m_file.read(static_cast<char*>(data), count);
+
+			if (static_cast<size_t>(m_file.gcount()) != count)
+			{
+				throw std::runtime_error("Failed to read the stream data");
+			}
+
+			m_position += count;
+			return count;
+		}
+
+	private:
+		std::ifstream m_file;
+		SoundRenderFormat m_format;
+		std::streamoff m_dataOffset;
+		uint64_t m_dataSize;
+		uint64_t m_position;
+	};
+}
+
+class StreamingSoundSource::Impl
+{
+public:
+	Impl(std::unique_ptr<SoundGenerator> generator, size_t blockSize, size_t buffersCount, bool refillThread) :
+		generator(std::move(generator)),
+		sourceId(alInvalidId),
+		looping(false),
+		streaming(false),
+		exit(false)
+	{
+		if (this->generator == nullptr)
+		{
+			throw std::invalid_argument("Generator can't be null");
+		}
+
+		if (buffersCount < 2)
+		{
+			throw std::invalid_argument("Streaming needs at least two buffers");
+		}
+
+		sourceFormat = this->generator->GetFormat();
+		format = ChooseAlFormat(sourceFormat.channelsCount, sourceFormat.bitsPerSample, sourceFormat.encoding);
+		auto sampleRate = sourceFormat.sampleRate;
+
+		// ADPCM blocks don't split into frames, such streams are not supported
+		size_t frameSize = sourceFormat.channelsCount * sourceFormat.bitsPerSample / 8;
+		if (frameSize == 0 || sampleRate == 0 || IsAdpcm(sourceFormat.encoding))
+		{
+			throw std::invalid_argument("Invalid stream format");
+		}
+
+		// Blocks must hold whole sample frames
+		blockSize = std::max(frameSize, blockSize - blockSize % frameSize);
+		block.resize(blockSize);
+
+		// Poll twice per block so a processed buffer never waits long for a refill
+		auto blockDuration = std::chrono::milliseconds(1000 * blockSize / (frameSize * sampleRate));
+		refillPeriod = std::min(
+			std::max(blockDuration / 2, std::chrono::milliseconds(5)),
+			std::chrono::milliseconds(100));
+
+		buffers.resize(buffersCount, alInvalidId);
+		OpenAlCallVoidStrict(alGenBuffers, static_cast<ALsizei>(buffers.size()), buffers.data());
+
+		try
+		{
+			OpenAlCallVoidStrict(alGenSources, 1, &sourceId);
+		}
+		catch (...)
+		{
+			alDeleteBuffers(static_cast<ALsizei>(buffers.size()), buffers.data());
+			throw;
+		}
+
+		alSourcef(sourceId, AL_PITCH, 1);
+		alSourcef(sourceId, AL_GAIN, 1);
+		alSource3f(sourceId, AL_POSITION, 0, 0, 0);
+		alSource3f(sourceId, AL_VELOCITY, 0, 0, 0);
+		alSourcei(sourceId, AL_LOOPING, AL_FALSE);
+
+		if (refillThread)
+		{
+			thread = std::thread([this]()
+			{
+				RefillThread();
+			});
+		}
+	}
+
+	~Impl()
+	{
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			exit = true;
+		}
+
+		wakeUp.notify_all();
+
+		if (thread.joinable())
+		{
+			thread.join();
+		}
+
+		alSourceStop(sourceId);
+		alSourcei(sourceId, AL_BUFFER, 0);
+		OpenAlCallVoid(alDeleteSources, 1, (const ALuint*)&sourceId);
+		OpenAlCallVoid(alDeleteBuffers,
+			static_cast<ALsizei>(buffers.size()),
+			(const ALuint*)buffers.data());
+	}
+
+	ALint GetAlState() const
+	{
+		ALint result;
+		OpenAlCallVoid(alGetSourcei,
+			sourceId,
+			static_cast<ALenum>(AL_SOURCE_STATE),
+			&result);
+
+		return result;
+	}
+
+	size_t ReadBlock()
+	{
+		size_t filled = 0;
+		bool rewound = false;
+
+		while (filled < block.size())
+		{
+			auto count = generator->Generate(block.data() + filled, block.size() - filled);
+
+			if (count == 0)
+			{
+				// Nothing right after a rewind means there is nothing to loop
+				if (!looping || rewound)
+				{
+					break;
+				}
+
+				generator->Rewind();
+				rewound = true;
+				continue;
+			}
+
+			filled += count;
+			rewound = false;
+		}
+
+		return filled;
+	}
+
+	// Reads and converts the next block, returns its size or zero at the end of the stream
+	size_t PrepareBlock(const void*& data)
+	{
+		auto size = ReadBlock();
+		data = block.data();
+
+		if (size != 0 && (format.encoding != sourceFormat.encoding || format.bitsPerSample != sourceFormat.bitsPerSample))
+		{
+			ConvertSamples(
+				sourceFormat.encoding, sourceFormat.bitsPerSample, block.data(), size,
+				format.encoding, format.bitsPerSample, converted);
+			data = converted.data();
+			size = converted.size();
+		}
+
+		return size;
+	}
+
+	void UploadBlock(ALuint buffer, const void* data, size_t size)
+	{
+		OpenAlCallVoidStrict(alBufferData,
+			buffer,
+			format.format,
+			(const ALvoid*)data,
+			static_cast<ALsizei>(size),
+			static_cast<ALsizei>(sourceFormat.sampleRate));
+	}
+
+	bool FillBuffer(ALuint buffer)
+	{
+		const void* data;
+		auto size = PrepareBlock(data);
+
+		if (size == 0)
+		{
+			return false;
+		}
+
+		UploadBlock(buffer, data, size);
+		return true;
+	}
+
+	void Start()
+	{
+		// A stopped source has all of its buffers processed, so they can be detached at once
+		OpenAlCallVoid(alSourcei, sourceId, static_cast<ALenum>(AL_BUFFER), static_cast<ALint>(0));
+		generator->Rewind();
+
+		for (auto buffer : buffers)
+		{
+			if (!FillBuffer(buffer))
+			{
+				break;
+			}
+
+			OpenAlCallVoid(alSourceQueueBuffers, sourceId, static_cast<ALsizei>(1), (const ALuint*)&buffer);
+		}
+
+		OpenAlCallVoid(alSourcePlay, sourceId);
+		streaming = true;
+	}
+
+	// Called with the generator mutex locked. The source mutex is only held around the AL calls,
+	// so reading and converting a block doesn't hold up the controls of the source
+	void Refill()
+	{
+		ALint processed = 0;
+
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+
+			if (!streaming)
+			{
+				return;
+			}
+
+			OpenAlCallVoidStrict(alGetSourcei,
+				sourceId,
+				static_cast<ALenum>(AL_BUFFERS_PROCESSED),
+				&processed);
+		}
+
+		for (; processed > 0; --processed)
+		{
+			const void* data;
+			auto size = PrepareBlock(data);
+
+			std::lock_guard<std::mutex> guard(mutex);
+
+			ALuint buffer;
+			OpenAlCallVoidStrict(alSourceUnqueueBuffers, sourceId, static_cast<ALsizei>(1), &buffer);
+
+			if (size != 0)
+			{
+				UploadBlock(buffer, data, size);
+				OpenAlCallVoidStrict(alSourceQueueBuffers, sourceId, static_cast<ALsizei>(1), (const ALuint*)&buffer);
+			}
+		}
+
+		std::lock_guard<std::mutex> guard(mutex);
+
+		ALint queued = 0;
+		OpenAlCallVoidStrict(alGetSourcei,
+			sourceId,
+			static_cast<ALenum>(AL_BUFFERS_QUEUED),
+			&queued);
+
+		if (queued == 0)
+		{
+			streaming = false;
+		}
+		else if (GetAlState() == AL_STOPPED)
+		{
+			// The source ran dry before the refill caught up
+			OpenAlCallVoidStrict(alSourcePlay, sourceId);
+		}
+	}
+
+	void RefillThread()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (!wakeUp.wait_for(lock, refillPeriod, [this]() { return exit; }))
+		{
+			if (!streaming)
+			{
+				continue;
+			}
+
+			lock.unlock();
+
+			try
+			{
+				Update();
+			}
+			catch (const std::exception&)
+			{
+			}
+
+			lock.lock();
+		}
+	}
+
+	void Update()
+	{
+		try
+		{
+			std::lock_guard<std::mutex> guard(generatorMutex);
+			Refill();
+		}
+		catch (...)
+		{
+			// A stream that can't be refilled ends here rather than looping its last buffers
+			std::lock_guard<std::mutex> guard(mutex);
+			streaming = false;
+			alSourceStop(sourceId);
+			throw;
+		}
+	}
+
+	std::unique_ptr<SoundGenerator> generator;
+	SoundRenderFormat sourceFormat;
+	AlFormat format;
+	std::vector<uint8_t> block;
+	std::vector<uint8_t> converted;
+
+	ALuint sourceId;
+	std::vector<ALuint> buffers;
+
+	std::atomic<bool> looping;
+	bool streaming;
+	bool exit;
+	std::chrono::milliseconds refillPeriod;
+	// Guards the generator and the blocks, taken before the source mutex
+	std::mutex generatorMutex;
+	// Guards the source and the flags
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::thread thread;
+};
+
+StreamingSoundSource::StreamingSoundSource(
+	const char* filename,
+	size_t blockSize,
+	size_t buffersCount,
+	bool refillThread) :
+	m_d(std::make_unique<Impl>(std::make_unique<WaveFileGenerator>(filename), blockSize, buffersCount, refillThread))
+{
+}
+
+StreamingSoundSource::StreamingSoundSource(
+	std::unique_ptr<SoundGenerator> generator,
+	size_t blockSize,
+	size_t buffersCount,
+	bool refillThread) :
+	m_d(std::make_unique<Impl>(std::move(generator), blockSize, buffersCount, refillThread))
+{
+}
+
+StreamingSoundSource::StreamingSoundSource(StreamingSoundSource&&) = default;
+StreamingSoundSource::~StreamingSoundSource() = default;
+StreamingSoundSource& StreamingSoundSource::operator=(StreamingSoundSource&&) = default;
+
+void StreamingSoundSource::Pause() const
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	OpenAlCallVoid(alSourcePause, m_d->sourceId);
+}
+
+void StreamingSoundSource::Play() const
+{
+	std::lock_guard<std::mutex> generatorGuard(m_d->generatorMutex);
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+
+	auto state = m_d->GetAlState();
+
+	// A stopped source that is still streaming is an underrun the refill thread will resume
+	if (state == AL_STOPPED && m_d->streaming)
+	{
+		return;
+	}
+
+	switch (state)
+	{
+	case AL_PLAYING:
+		break;
+	case AL_PAUSED:
+		OpenAlCallVoid(alSourcePlay, m_d->sourceId);
+		break;
+	default:
+		m_d->Start();
+		break;
+	}
+}
+
+void StreamingSoundSource::Stop() const
+{
+	std::lock_guard<std::mutex> generatorGuard(m_d->generatorMutex);
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	m_d->streaming = false;
+	OpenAlCallVoid(alSourceStop, m_d->sourceId);
+	OpenAlCallVoid(alSourcei, m_d->sourceId, static_cast<ALenum>(AL_BUFFER), static_cast<ALint>(0));
+	m_d->generator->Rewind();
+}
+
+SoundSourceState StreamingSoundSource::GetState() const
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	auto state = m_d->GetAlState();
+
+	// An underrun is reported as playing: the refill thread restarts the source
+	if (state == AL_STOPPED && m_d->streaming)
+	{
+		return SoundSourceState::Playing;
+	}
+
+	return ToSoundSourceState(state);
+}
+
+void StreamingSoundSource::Update()
+{
+	m_d->Update();
+}
+
+void StreamingSoundSource::SetLooping(bool looping)
+{
+	m_d->looping = looping;
+}
+
+bool StreamingSoundSource::GetLooping() const
+{
+	return m_d->looping;
+}
+
+void StreamingSoundSource::SetGain(float gain)
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	OpenAlCallVoid(alSourcef, m_d->sourceId, static_cast<ALenum>(AL_GAIN), gain);
+}
+
+void StreamingSoundSource::SetPitch(float pitch)
+{
+	std::lock_guard<std::mutex> guard(m_d->mutex);
+	OpenAlCallVoid(alSourcef, m_d->sourceId, static_cast<ALenum>(AL_PITCH), pitch);
+}
\ No newline at end of file
@@ -1,173 +1,284 @@
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
+#include "Adpcm.h"
+#include "MappedFile.h"
+#include "MemoryStream.h"
+#include "SampleConversion.h"
+#include "WaveFile.h"
+
 #include "SoundTools/WaveBuffer.h"
+#include "SoundTools/WaveWriter.h"
 
 namespace
 {
-	struct WavFile
+	std::unique_ptr<uint8_t[]> ReadWavData(std::istream& file, size_t dataSize)
 	{
-		struct
-		{
-			char chunkId[4];
-			uint32_t chunkSize;
-			char format[4];
-		} riff;
+		std::unique_ptr<uint8_t[]> data(new uint8_t[dataSize]);
+		file.read(reinterpret_cast<char*>(data.get()), dataSize);
+		return data;
+	}
 
-		struct
-		{
-			char subchunk1Id[4];
-			uint32_t subchunk1Size;
-			uint16_t audioFormat;
-			uint16_t numChannels;
-			uint32_t sampleRate;
-			uint32_t byteRate;
-			uint16_t blockAlign;
-			uint16_t bitsPerSample;
-		} format;
-
-		struct
+	// A 32-bit process can't hold or map more than its address space
+	void CheckAddressable(const WaveFileHeader& header)
+	{
+		if (header.dataOffset + header.dataSize > std::numeric_limits<size_t>::max())
 		{
-			char subchunk2Id[4];
-			uint32_t subchunk2Size;
-			std::unique_ptr<uint8_t[]> data;
-		} data;
-	};
+			throw std::runtime_error("The file is too large to load, stream it instead");
+		}
+	}
 
-	WavFile ReadWavFile(std::ifstream& file)
+	size_t ResolveBlockAlign(SampleEncoding encoding, size_t channelsCount, size_t bitsPerSample, size_t blockAlign)
 	{
-		WavFile result;
-
-		auto check = [](bool cond, const char* message)
+		if (IsAdpcm(encoding))
 		{
-			if (!cond)
-			{
-				throw std::invalid_argument(message);
-			}
-		};
+			return blockAlign == 0 ? GetDefaultAdpcmBlockAlign(encoding, channelsCount) : blockAlign;
+		}
+
+		return channelsCount * bitsPerSample / 8;
+	}
+}
 
-		auto invalidFileFormatMessage = "Invalid file format";
+WaveBuffer::WaveBuffer(const char* filename, WaveBufferStorage storage)
+{
+	std::ifstream file(filename, std::ios::binary);
+
+	if (!file.is_open())
+	{
+		throw std::invalid_argument("Failed to open the file");
+	}
 
-		file.read(reinterpret_cast<char*>(&result.riff), sizeof(result.riff));
-		check(strncmp(result.riff.chunkId, "RIFF", 4) == 0, invalidFileFormatMessage);
-		check(strncmp(result.riff.format, "WAVE", 4) == 0, invalidFileFormatMessage);
+	auto header = ReadWaveFileHeader(file);
+	CheckAddressable(header);
 
-		file.read(reinterpret_cast<char*>(&result.format), sizeof(result.format));
-		check(strncmp(result.format.subchunk1Id, "fmt ", 4) == 0, invalidFileFormatMessage);
-		check(result.format.audioFormat == 1, invalidFileFormatMessage);
+	m_channelsCount = header.format.numChannels;
+	m_bitsPerSample = header.format.bitsPerSample;
+	m_sampleRate = header.format.sampleRate;
+	m_dataSize = static_cast<size_t>(header.dataSize);
+	m_blockAlign = ResolveBlockAlign(header.encoding, m_channelsCount, m_bitsPerSample, header.format.blockAlign);
+	m_encoding = header.encoding;
+	m_chunks = std::move(header.chunks);
 
-		file.read(reinterpret_cast<char*>(&result.data.subchunk2Id), sizeof(result.data.subchunk2Id));
-		check(strncmp(result.data.subchunk2Id, "data", 4) == 0, invalidFileFormatMessage);
+	if (storage == WaveBufferStorage::Mapped)
+	{
+		auto dataOffset = static_cast<size_t>(header.dataOffset);
+		file.close();
 
-		file.read(reinterpret_cast<char*>(&result.data.subchunk2Size), sizeof(result.data.subchunk2Size));
+		m_mapping = std::make_shared<const MappedFile>(filename);
 
-		result.data.data.reset(new uint8_t[result.data.subchunk2Size]);
-		file.read(reinterpret_cast<char*>(result.data.data.get()), result.data.subchunk2Size);
+		if (dataOffset + m_dataSize > m_mapping->GetSize())
+		{
+			throw std::invalid_argument("Invalid file format");
+		}
 
-		return result;
+		m_view = m_mapping->GetData() + dataOffset;
+	}
+	else
+	{
+		m_data = ReadWavData(file, m_dataSize);
+		m_view = m_data.get();
 	}
 }
 
-WaveBuffer::WaveBuffer(const char* filename)
+WaveBuffer::WaveBuffer(std::unique_ptr<uint8_t[]>&& file, size_t fileSize)
 {
-	std::ifstream file(filename, std::ios::binary);
+	MemoryStreamBuffer buffer(file.get(), fileSize);
+	std::istream stream(&buffer);
 
-	if (!file.is_open())
+	auto header = ReadWaveFileHeader(stream);
+	CheckAddressable(header);
+
+	m_channelsCount = header.format.numChannels;
+	m_bitsPerSample = header.format.bitsPerSample;
+	m_sampleRate = header.format.sampleRate;
+	m_dataSize = static_cast<size_t>(header.dataSize);
+	m_blockAlign = ResolveBlockAlign(header.encoding, m_channelsCount, m_bitsPerSample, header.format.blockAlign);
+	m_encoding = header.encoding;
+	m_chunks = std::move(header.chunks);
+
+	if (header.dataOffset + header.dataSize > fileSize)
 	{
-		throw std::invalid_argument("Failed to open the file");
+		throw std::invalid_argument("Invalid file format");
 	}
 
-	auto fileData = ReadWavFile(file);
-	m_channelsCount = fileData.format.numChannels;
-	m_bitsPerSample = fileData.format.bitsPerSample;
-	m_sampleRate = fileData.format.sampleRate;
-	m_dataSize = fileData.data.subchunk2Size;
-	m_data = std::move(fileData.data.data);
+	m_data = std::move(file);
+	m_view = m_data.get() + header.dataOffset;
 }
 
 WaveBuffer::WaveBuffer(
 	size_t channelsCount, size_t bitsPerSample, size_t sampleRate,
-	void* data, size_t dataSize) :
+	void* data, size_t dataSize,
+	SampleEncoding encoding,
+	size_t blockAlign) :
 	m_channelsCount(channelsCount),
 	m_bitsPerSample(bitsPerSample),
 	m_sampleRate(sampleRate),
-	m_dataSize(dataSize)
+	m_dataSize(dataSize),
+	m_blockAlign(ResolveBlockAlign(encoding, channelsCount, bitsPerSample, blockAlign)),
+	m_encoding(encoding)
 {
 	m_data.reset(new uint8_t[m_dataSize]);
 	std::memcpy(m_data.get(), data, m_dataSize);
+	m_view = m_data.get();
 }
 
 WaveBuffer::WaveBuffer(
 	size_t channelsCount, size_t bitsPerSample, size_t sampleRate,
-	std::unique_ptr<uint8_t[]>&& data, size_t dataSize) :
+	std::unique_ptr<uint8_t[]>&& data, size_t dataSize,
+	SampleEncoding encoding,
+	size_t blockAlign) :
+	m_channelsCount(channelsCount),
+	m_bitsPerSample(bitsPerSample),
+	m_sampleRate(sampleRate),
+	m_dataSize(dataSize),
+	m_blockAlign(ResolveBlockAlign(encoding, channelsCount, bitsPerSample, blockAlign)),
+	m_encoding(encoding),
+	m_data(std::move(data)),
+	m_view(m_data.get())
+{}
+
+WaveBuffer::WaveBuffer(
+	std::shared_ptr<const MappedFile> mapping, const uint8_t* view, size_t dataSize,
+	size_t channelsCount, size_t bitsPerSample, size_t sampleRate,
+	SampleEncoding encoding, size_t blockAlign) :
 	m_channelsCount(channelsCount),
 	m_bitsPerSample(bitsPerSample),
 	m_sampleRate(sampleRate),
 	m_dataSize(dataSize),
-	m_data(std::move(data))
+	m_blockAlign(ResolveBlockAlign(encoding, channelsCount, bitsPerSample, blockAlign)),
+	m_encoding(encoding),
+	m_mapping(std::move(mapping)),
+	m_view(view)
 {}
 
+size_t WaveBuffer::GetChannelsCount() const
+{
+	return m_channelsCount;
+}
+
+size_t WaveBuffer::GetBitsPerSample() const
+{
+	return m_bitsPerSample;
+}
+
+size_t WaveBuffer::GetSampleRate() const
+{
+	return m_sampleRate;
+}
+
+SampleEncoding WaveBuffer::GetEncoding() const
+{
+	return m_encoding;
+}
+
+size_t WaveBuffer::GetBlockAlign() const
+{
+	return m_blockAlign;
+}
+
+size_t WaveBuffer::GetFramesCount() const
+{
+	return static_cast<size_t>(::GetFramesCount(m_encoding, m_channelsCount, m_bitsPerSample, m_blockAlign, m_dataSize));
+}
+
+const void* WaveBuffer::GetData() const
+{
+	return m_view;
+}
+
+size_t WaveBuffer::GetDataSize() const
+{
+	return m_dataSize;
+}
+
+bool WaveBuffer::IsMapped() const
+{
+	return m_mapping != nullptr;
+}
+
+const WaveChunkIndex& WaveBuffer::GetChunkIndex() const
+{
+	return m_chunks;
+}
+
 SoundBuffer WaveBuffer::MakeSoundBuffer() const
 {
 	return SoundBuffer(
 		m_channelsCount,
 		m_bitsPerSample,
 		m_sampleRate,
-		m_data.get(),
-		m_dataSize);
+		m_view,
+		m_dataSize,
+		m_encoding,
+		m_blockAlign);
 }
 
-void WaveBuffer::SaveToFile(const char* filename) const
+void WaveBuffer::SaveToFile(const char* filename, WaveContainer container) const
 {
-	std::ofstream file(filename,
-		std::ios::binary |
-		std::ios::out |
-		std::ios::trunc);
+	WaveWriter writer(
+		filename,
+		m_channelsCount, m_bitsPerSample, m_sampleRate,
+		m_encoding, m_blockAlign,
+		container);
+	writer.Write(m_view, m_dataSize);
+	writer.Close();
+}
 
-	if (!file.is_open())
+WaveBuffer WaveBuffer::Encode(SampleEncoding encoding, size_t blockAlign) const
+{
+	// Everything goes through 16-bit PCM
+	std::vector<uint8_t> pcm;
+
+	if (IsAdpcm(m_encoding))
 	{
-		throw std::runtime_error("Could not create the file");
+		DecodeAdpcm(m_encoding, m_channelsCount, m_blockAlign, m_view, m_dataSize, pcm);
+	}
+	else if (m_encoding == SampleEncoding::Pcm && m_bitsPerSample == 8)
+	{
+		std::vector<uint8_t> floats;
+		ConvertSamples(m_encoding, m_bitsPerSample, m_view, m_dataSize, SampleEncoding::Float, 32, floats);
+		ConvertSamples(SampleEncoding::Float, 32, floats.data(), floats.size(), SampleEncoding::Pcm, 16, pcm);
+	}
+	else
+	{
+		ConvertSamples(m_encoding, m_bitsPerSample, m_view, m_dataSize, SampleEncoding::Pcm, 16, pcm);
 	}
 
-	WavFile wavData;
-
-	// RIFF
-	std::memcpy(&wavData.riff.chunkId, "RIFF", sizeof(wavData.riff.chunkId));
-	wavData.riff.chunkSize = 36 + m_dataSize;
-	std::memcpy(&wavData.riff.format, "WAVE", sizeof(wavData.riff.format));
-
-	file.write(
-		reinterpret_cast<const char*>(&wavData.riff),
-		sizeof(wavData.riff));
-
-	// FORMAT
-	size_t sampleBytesCount = m_bitsPerSample / 8;
-	std::memcpy(&wavData.format.subchunk1Id, "fmt ", sizeof(wavData.format.subchunk1Id));
-	wavData.format.subchunk1Size = 16;
-	wavData.format.audioFormat = 1;
-	wavData.format.numChannels = m_channelsCount;
-	wavData.format.sampleRate = m_sampleRate;
-	wavData.format.byteRate = m_sampleRate * sampleBytesCount;
-	wavData.format.blockAlign = m_channelsCount * sampleBytesCount;
-	wavData.format.bitsPerSample = m_bitsPerSample;
-
-	file.write(
-		reinterpret_cast<const char*>(&wavData.format),
-		sizeof(wavData.format));
-
-	// Data
-	file.write("data", 4);
+	std::vector<uint8_t> encoded;
+	size_t bitsPerSample;
 
-	auto dataSize = static_cast<uint32_t>(m_dataSize);
-	file.write(
-		reinterpret_cast<const char*>(&dataSize),
-		sizeof(dataSize));
-	file.write(
-		reinterpret_cast<const char*>(m_data.get()),
-		m_dataSize);
+	switch (encoding)
+	{
+	case SampleEncoding::Pcm:
+		encoded = std::move(pcm);
+		bitsPerSample = 16;
+		break;
+	case SampleEncoding::MuLaw:
+		ConvertSamples(SampleEncoding::Pcm, 16, pcm.data(), pcm.size(), SampleEncoding::MuLaw, 8, encoded);
+		bitsPerSample = 8;
+		break;
+	case SampleEncoding::ImaAdpcm:
+	case SampleEncoding::MsAdpcm:
+		blockAlign = blockAlign == 0 ? GetDefaultAdpcmBlockAlign(encoding, m_channelsCount) : blockAlign;
+		EncodeAdpcm(
+			encoding, m_channelsCount, blockAlign,
+			reinterpret_cast<const int16_t*>(pcm.data()), pcm.size() / (m_channelsCount * sizeof(int16_t)),
+			encoded);
+		bitsPerSample = 4;
+		break;
+	default:
+		throw std::invalid_argument("Unsupported target encoding");
+	}
 
-	file.close();
+	return WaveBuffer(
+		m_channelsCount, bitsPerSample, m_sampleRate,
+		encoded.data(), encoded.size(),
+		encoding, blockAlign);
 }
 
 WaveBuffer::WaveBuffer(WaveBuffer&&) = default;
+WaveBuffer::~WaveBuffer() = default;
 WaveBuffer& WaveBuffer::operator=(WaveBuffer&&) = default;
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include <cstring>
+
+#include "SoundTools/WaveChunkIndex.h"
+
+WaveChunkIndex::WaveChunkIndex() = default;
+
+WaveChunkIndex::WaveChunkIndex(std::vector<WaveChunk>&& chunks) :
+	m_chunks(std::move(chunks))
+{}
+
+const WaveChunk* WaveChunkIndex::Find(const char* id) const
+{
+	for (auto& chunk : m_chunks)
+	{
+		if (strncmp(chunk.id, id, sizeof(chunk.id)) == 0)
+		{
+			return &chunk;
+		}
+	}
+
+	return nullptr;
+}
+
+const std::vector<WaveChunk>& WaveChunkIndex::GetChunks() const
+{
+	return m_chunks;
+}
\ No newline at end of file
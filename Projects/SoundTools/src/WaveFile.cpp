@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "Adpcm.h"
+#include "WaveFile.h"
+
+namespace
+{
+	struct ChunkHeader
+	{
+		char id[4];
+		uint32_t size;
+	};
+
+	struct RiffHeader
+	{
+		ChunkHeader chunk;
+		char format[4];
+	};
+}
+
+const uint8_t wave64RiffGuid[16] =
+{
+	'r', 'i', 'f', 'f', 0x2E, 0x91, 0xCF, 0x11, 0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00
+};
+
+const uint8_t wave64WaveGuid[16] =
+{
+	'w', 'a', 'v', 'e', 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A
+};
+
+void MakeWave64Guid(const char* fourCC, uint8_t guid[16])
+{
+	// The standard chunk GUIDs share the tail of the "wave" GUID
+	std::memcpy(guid, wave64WaveGuid, sizeof(wave64WaveGuid));
+	std::memcpy(guid, fourCC, 4);
+}
+
+WaveFileHeader ReadWaveFileHeader(std::istream& file)
+{
+	WaveFileHeader result;
+
+	auto check = [](bool cond, const char* message)
+	{
+		if (!cond)
+		{
+			throw std::invalid_argument(message);
+		}
+	};
+
+	auto invalidFileFormatMessage = "Invalid file format";
+
+	file.seekg(0, std::ios::end);
+	auto fileSize = static_cast<uint64_t>(file.tellg());
+	file.seekg(0, std::ios::beg);
+
+	RiffHeader riff;
+	file.read(reinterpret_cast<char*>(&riff), sizeof(riff));
+	check(file.good(), invalidFileFormatMessage);
+
+	uint64_t end = 0;
+	uint64_t position = 0;
+	// RF64 keeps the sizes that don't fit 32 bits in its ds64 chunk
+	uint64_t ds64DataSize = 0;
+	std::vector<WaveChunk> ds64Table;
+
+	if ((strncmp(riff.chunk.id, "RIFF", 4) == 0 || strncmp(riff.chunk.id, "RF64", 4) == 0 || strncmp(riff.chunk.id, "BW64", 4) == 0) &&
+		strncmp(riff.format, "WAVE", 4) == 0)
+	{
+		result.container = strncmp(riff.chunk.id, "RIFF", 4) == 0 ? WaveContainer::Riff : WaveContainer::Rf64;
+		uint64_t riffSize = riff.chunk.size;
+		position = sizeof(riff);
+
+		if (result.container == WaveContainer::Rf64)
+		{
+			ChunkHeader header;
+			uint64_t sizes[3];
+			uint32_t tableLength = 0;
+			file.read(reinterpret_cast<char*>(&header), sizeof(header));
+			file.read(reinterpret_cast<char*>(sizes), sizeof(sizes));
+			file.read(reinterpret_cast<char*>(&tableLength), sizeof(tableLength));
+			check(file.good(), invalidFileFormatMessage);
+			check(strncmp(header.id, "ds64", 4) == 0 && header.size >= ds64Size, invalidFileFormatMessage);
+			check(tableLength <= (header.size - ds64Size) / 12, invalidFileFormatMessage);
+
+			riffSize = sizes[0];
+			ds64DataSize = sizes[1];
+
+			for (uint32_t i = 0; i < tableLength; ++i)
+			{
+				WaveChunk entry;
+				file.read(entry.id, sizeof(entry.id));
+				file.read(reinterpret_cast<char*>(&entry.size), sizeof(entry.size));
+				check(file.good(), invalidFileFormatMessage);
+				ds64Table.push_back(entry);
+			}
+		}
+
+		// Trust the file size over the RIFF size: writers that crashed leave it stale
+		end = std::min<uint64_t>(fileSize, sizeof(ChunkHeader) + riffSize);
+	}
+	else
+	{
+		uint8_t header[2 * sizeof(wave64RiffGuid) + sizeof(uint64_t)];
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(header), sizeof(header));
+		check(file.good(), invalidFileFormatMessage);
+		check(std::memcmp(header, wave64RiffGuid, sizeof(wave64RiffGuid)) == 0, invalidFileFormatMessage);
+		check(std::memcmp(header + 24, wave64WaveGuid, sizeof(wave64WaveGuid)) == 0, invalidFileFormatMessage);
+
+		uint64_t riffSize;
+		std::memcpy(&riffSize, header + 16, sizeof(riffSize));
+
+		result.container = WaveContainer::Wave64;
+		position = sizeof(header);
+		end = std::min<uint64_t>(fileSize, riffSize);
+	}
+
+	if (end < position)
+	{
+		end = fileSize;
+	}
+
+	bool wave64 = result.container == WaveContainer::Wave64;
+	uint64_t chunkHeaderSize = wave64 ? wave64ChunkHeaderSize : sizeof(ChunkHeader);
+
+	std::vector<WaveChunk> chunks;
+	bool hasFormat = false;
+	uint16_t formatTag = 0;
+	// Samples per block as stated in the file, and whether the coefficients are the standard ones
+	uint16_t samplesPerBlock = 0;
+	bool standardCoefficients = false;
+
+	while (position + chunkHeaderSize <= end)
+	{
+		WaveChunk chunk;
+		uint64_t size = 0;
+		file.seekg(position);
+
+		if (wave64)
+		{
+			uint8_t guid[16];
+			file.read(reinterpret_cast<char*>(guid), sizeof(guid));
+			file.read(reinterpret_cast<char*>(&size), sizeof(size));
+			check(file.good() && size >= wave64ChunkHeaderSize, invalidFileFormatMessage);
+
+			std::memcpy(chunk.id, guid, sizeof(chunk.id));
+			size -= wave64ChunkHeaderSize;
+		}
+		else
+		{
+			ChunkHeader header;
+			file.read(reinterpret_cast<char*>(&header), sizeof(header));
+			check(file.good(), invalidFileFormatMessage);
+
+			std::memcpy(chunk.id, header.id, sizeof(chunk.id));
+			size = header.size;
+
+			if (result.container == WaveContainer::Rf64 && header.size == rf64SizePlaceholder)
+			{
+				if (strncmp(header.id, "data", 4) == 0)
+				{
+					size = ds64DataSize;
+				}
+				else
+				{
+					auto entry = std::find_if(ds64Table.begin(), ds64Table.end(), [&header](const WaveChunk& entry)
+					{
+						return strncmp(entry.id, header.id, 4) == 0;
+					});
+
+					check(entry != ds64Table.end(), invalidFileFormatMessage);
+					size = entry->size;
+				}
+			}
+		}
+
+		chunk.offset = position + chunkHeaderSize;
+		chunk.size = std::min<uint64_t>(size, end - chunk.offset);
+		chunks.push_back(chunk);
+
+		if (!hasFormat && strncmp(chunk.id, "fmt ", 4) == 0)
+		{
+			check(chunk.size >= sizeof(WaveFormat), invalidFileFormatMessage);
+			file.read(reinterpret_cast<char*>(&result.format), sizeof(result.format));
+			check(file.good(), invalidFileFormatMessage);
+
+			formatTag = result.format.audioFormat;
+			if (formatTag == WaveFormatExtensible)
+			{
+				WaveFormatExtension extension;
+				check(chunk.size >= sizeof(WaveFormat) + sizeof(extension), invalidFileFormatMessage);
+				file.read(reinterpret_cast<char*>(&extension), sizeof(extension));
+				check(file.good(), invalidFileFormatMessage);
+				formatTag = extension.subFormat;
+			}
+			else if (formatTag == WaveFormatImaAdpcm || formatTag == WaveFormatMsAdpcm)
+			{
+				WaveFormatAdpcm extension;
+				check(chunk.size >= sizeof(WaveFormat) + sizeof(extension), invalidFileFormatMessage);
+				file.read(reinterpret_cast<char*>(&extension), sizeof(extension));
+				check(file.good(), invalidFileFormatMessage);
+				samplesPerBlock = extension.samplesPerBlock;
+
+				if (formatTag == WaveFormatMsAdpcm)
+				{
+					uint16_t coefficientsCount = 0;
+					int16_t coefficients[msAdpcmCoefficientsCount][2];
+					file.read(reinterpret_cast<char*>(&coefficientsCount), sizeof(coefficientsCount));
+					file.read(reinterpret_cast<char*>(coefficients), sizeof(coefficients));
+
+					standardCoefficients =
+						file.good() &&
+						coefficientsCount == msAdpcmCoefficientsCount &&
+						std::memcmp(coefficients, msAdpcmCoefficients, sizeof(coefficients)) == 0;
+				}
+			}
+
+			hasFormat = true;
+		}
+
+		// RIFF chunks are word aligned, the pad byte is not counted in the size
+		position = wave64 ?
+			chunk.offset + (chunk.size + wave64Alignment - 1) / wave64Alignment * wave64Alignment :
+			chunk.offset + chunk.size + (chunk.size & 1);
+	}
+
+	result.chunks = WaveChunkIndex(std::move(chunks));
+
+	auto data = result.chunks.Find("data");
+	check(hasFormat && data != nullptr, invalidFileFormatMessage);
+
+	auto bits = result.format.bitsPerSample;
+	auto channels = result.format.numChannels;
+	check(channels != 0 && result.format.sampleRate != 0, invalidFileFormatMessage);
+
+	// Frames of uncompressed formats are exactly one sample per channel
+	auto checkFrameSize = [&]()
+	{
+		check(result.format.blockAlign == channels * bits / 8, invalidFileFormatMessage);
+	};
+
+	switch (formatTag)
+	{
+	case WaveFormatPcm:
+		check(bits == 8 || bits == 16 || bits == 24 || bits == 32, invalidFileFormatMessage);
+		checkFrameSize();
+		result.encoding = SampleEncoding::Pcm;
+		break;
+	case WaveFormatIeeeFloat:
+		check(bits == 32 || bits == 64, invalidFileFormatMessage);
+		checkFrameSize();
+		result.encoding = SampleEncoding::Float;
+		break;
+	case WaveFormatMuLaw:
+		check(bits == 8, invalidFileFormatMessage);
+		checkFrameSize();
+		result.encoding = SampleEncoding::MuLaw;
+		break;
+	case WaveFormatImaAdpcm:
+	case WaveFormatMsAdpcm:
+		result.encoding = formatTag == WaveFormatImaAdpcm ? SampleEncoding::ImaAdpcm : SampleEncoding::MsAdpcm;
+		check(bits == 4, invalidFileFormatMessage);
+		check(
+			samplesPerBlock != 0 &&
+			samplesPerBlock == GetAdpcmFramesPerBlock(result.encoding, result.format.numChannels, result.format.blockAlign),
+			invalidFileFormatMessage);
+
+		if (result.encoding == SampleEncoding::MsAdpcm && !standardCoefficients)
+		{
+			throw std::invalid_argument("Unsupported sample format");
+		}
+		break;
+	default:
+		throw std::invalid_argument("Unsupported sample format");
+	}
+
+	result.dataOffset = data->offset;
+	result.dataSize = data->size;
+
+	file.clear();
+	file.seekg(result.dataOffset);
+
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+
+#include "SoundTools/SampleEncoding.h"
+#include "SoundTools/WaveContainer.h"
+#include "SoundTools/WaveChunkIndex.h"
+
+enum : uint16_t
+{
+	WaveFormatPcm = 0x0001,
+	WaveFormatMsAdpcm = 0x0002,
+	WaveFormatIeeeFloat = 0x0003,
+	WaveFormatMuLaw = 0x0007,
+	WaveFormatImaAdpcm = 0x0011,
+	WaveFormatExtensible = 0xFFFE
+};
+
+struct WaveFormat
+{
+	uint16_t audioFormat;
+	uint16_t numChannels;
+	uint32_t sampleRate;
+	uint32_t byteRate;
+	uint16_t blockAlign;
+	uint16_t bitsPerSample;
+};
+
+// Tail of an ADPCM fmt chunk, Microsoft ADPCM follows it with its coefficient pairs
+struct WaveFormatAdpcm
+{
+	uint16_t extensionSize;
+	uint16_t samplesPerBlock;
+};
+
+// Tail of a WAVE_FORMAT_EXTENSIBLE fmt chunk
+struct WaveFormatExtension
+{
+	uint16_t extensionSize;
+	uint16_t validBitsPerSample;
+	uint32_t channelMask;
+	// The sub-format GUID starts with the format tag it stands for
+	uint16_t subFormat;
+	uint8_t subFormatGuidTail[14];
+};
+
+// Payload of an RF64 ds64 chunk without the table that follows it
+constexpr uint32_t ds64Size = 28;
+// Stands for a size stored in the ds64 chunk
+constexpr uint32_t rf64SizePlaceholder = 0xFFFFFFFF;
+
+// Wave64 chunk header: a GUID and the size of the chunk including the header.
+// Chunks start at multiples of 8 bytes.
+constexpr uint32_t wave64ChunkHeaderSize = 24;
+constexpr uint32_t wave64Alignment = 8;
+extern const uint8_t wave64RiffGuid[16];
+extern const uint8_t wave64WaveGuid[16];
+
+// GUID of a standard Wave64 chunk such as "fmt " or "data"
+void MakeWave64Guid(const char* fourCC, uint8_t guid[16]);
+
+struct WaveFileHeader
+{
+	WaveContainer container;
+	WaveFormat format;
+	SampleEncoding encoding;
+	uint64_t dataOffset;
+	uint64_t dataSize;
+	WaveChunkIndex chunks;
+};
+
+// Walks the top-level chunks once and leaves the stream at the first data byte.
+// Chunk ids of Wave64 files are the first four bytes of their GUIDs.
+WaveFileHeader ReadWaveFileHeader(std::istream& file);
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include <limits>
+
+#include "SoundTools/WaveFileSoundBackend.h"
+#include "SoundTools/WaveWriter.h"
+
+class WaveFileSoundBackend::Impl
+{
+public:
+	Impl(const char* filename, size_t channelsCount, size_t sampleRate) :
+		writer(filename, channelsCount, 32, sampleRate, SampleEncoding::Float),
+		channelsCount(channelsCount)
+	{}
+
+	WaveWriter writer;
+	size_t channelsCount;
+};
+
+WaveFileSoundBackend::WaveFileSoundBackend(const char* filename, size_t channelsCount, size_t sampleRate, double flushInterval) :
+	m_d(std::make_unique<Impl>(filename, channelsCount, sampleRate))
+{
+	m_d->writer.SetFlushInterval(flushInterval);
+}
+
+WaveFileSoundBackend::~WaveFileSoundBackend() = default;
+
+size_t WaveFileSoundBackend::GetWritableFrames()
+{
+	return std::numeric_limits<size_t>::max();
+}
+
+void WaveFileSoundBackend::Write(const float* frames, size_t framesCount)
+{
+	m_d->writer.Write(frames, framesCount * m_d->channelsCount * sizeof(float));
+}
+
+size_t WaveFileSoundBackend::GetWrittenFrames() const
+{
+	return static_cast<size_t>(m_d->writer.GetFramesCount());
+}
+
+void WaveFileSoundBackend::Close()
+{
+	m_d->writer.Close();
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <fstream>
+#include <stdexcept>
+
+#include "SampleConversion.h"
+#include "WaveFile.h"
+
+#include "SoundTools/WaveInfo.h"
+
+WaveInfo::WaveInfo(const char* filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+
+	if (!file.is_open())
+	{
+		throw std::invalid_argument("Failed to open the file");
+	}
+
+	auto header = ReadWaveFileHeader(file);
+	m_channelsCount = header.format.numChannels;
+	m_bitsPerSample = header.format.bitsPerSample;
+	m_sampleRate = header.format.sampleRate;
+	m_encoding = header.encoding;
+	m_blockAlign = header.format.blockAlign;
+	m_container = header.container;
+	m_dataOffset = header.dataOffset;
+	m_dataSize = header.dataSize;
+	m_chunks = std::move(header.chunks);
+}
+
+size_t WaveInfo::GetChannelsCount() const
+{
+	return m_channelsCount;
+}
+
+size_t WaveInfo::GetBitsPerSample() const
+{
+	return m_bitsPerSample;
+}
+
+size_t WaveInfo::GetSampleRate() const
+{
+	return m_sampleRate;
+}
+
+SampleEncoding WaveInfo::GetEncoding() const
+{
+	return m_encoding;
+}
+
+size_t WaveInfo::GetBlockAlign() const
+{
+	return m_blockAlign;
+}
+
+WaveContainer WaveInfo::GetContainer() const
+{
+	return m_container;
+}
+
+uint64_t WaveInfo::GetDataOffset() const
+{
+	return m_dataOffset;
+}
+
+uint64_t WaveInfo::GetDataSize() const
+{
+	return m_dataSize;
+}
+
+uint64_t WaveInfo::GetFramesCount() const
+{
+	return ::GetFramesCount(m_encoding, m_channelsCount, m_bitsPerSample, m_blockAlign, m_dataSize);
+}
+
+double WaveInfo::GetDuration() const
+{
+	return m_sampleRate == 0 ? 0.0 : static_cast<double>(GetFramesCount()) / m_sampleRate;
+}
+
+const WaveChunkIndex& WaveInfo::GetChunkIndex() const
+{
+	return m_chunks;
+}
\ No newline at end of file
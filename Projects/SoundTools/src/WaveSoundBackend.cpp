@@ -0,0 +1,67 @@
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "SoundTools/WaveSoundBackend.h"
+#include "SoundTools/WaveWriter.h"
+
+class WaveSoundBackend::Impl
+{
+public:
+	size_t channelsCount;
+	size_t sampleRate;
+	std::vector<float> samples;
+};
+
+WaveSoundBackend::WaveSoundBackend(size_t channelsCount, size_t sampleRate) :
+	m_d(std::make_unique<Impl>())
+{
+	if (channelsCount == 0 || sampleRate == 0)
+	{
+		throw std::invalid_argument("Invalid wave format");
+	}
+
+	m_d->channelsCount = channelsCount;
+	m_d->sampleRate = sampleRate;
+}
+
+WaveSoundBackend::~WaveSoundBackend() = default;
+
+size_t WaveSoundBackend::GetWritableFrames()
+{
+	return std::numeric_limits<size_t>::max();
+}
+
+void WaveSoundBackend::Write(const float* frames, size_t framesCount)
+{
+	m_d->samples.insert(m_d->samples.end(), frames, frames + framesCount * m_d->channelsCount);
+}
+
+size_t WaveSoundBackend::GetWrittenFrames() const
+{
+	return m_d->samples.size() / m_d->channelsCount;
+}
+
+WaveBuffer WaveSoundBackend::MakeWaveBuffer() const
+{
+	auto dataSize = m_d->samples.size() * sizeof(float);
+	std::unique_ptr<uint8_t[]> data(new uint8_t[dataSize]);
+
+	if (dataSize != 0)
+	{
+		std::memcpy(data.get(), m_d->samples.data(), dataSize);
+	}
+
+	return WaveBuffer(
+		m_d->channelsCount, 32, m_d->sampleRate,
+		std::move(data), dataSize,
+		SampleEncoding::Float);
+}
+
+void WaveSoundBackend::SaveToFile(const char* filename) const
+{
+	WaveWriter writer(filename, m_d->channelsCount, 32, m_d->sampleRate, SampleEncoding::Float);
+	writer.Write(m_d->samples.data(), m_d->samples.size() * sizeof(float));
+	writer.Close();
+}
\ No newline at end of file
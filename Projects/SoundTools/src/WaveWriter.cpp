@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "Adpcm.h"
+#include "SampleConversion.h"
+#include "WaveFile.h"
+
+#include "SoundTools/WaveWriter.h"
+
+namespace
+{
+	uint16_t ToWaveFormatTag(SampleEncoding encoding)
+	{
+		switch (encoding)
+		{
+		case SampleEncoding::Float: return WaveFormatIeeeFloat;
+		case SampleEncoding::MuLaw: return WaveFormatMuLaw;
+		case SampleEncoding::ImaAdpcm: return WaveFormatImaAdpcm;
+		case SampleEncoding::MsAdpcm: return WaveFormatMsAdpcm;
+		default: return WaveFormatPcm;
+		}
+	}
+
+	// fmt chunk bytes after WaveFormat, ADPCM only
+	std::vector<uint8_t> MakeFormatExtension(SampleEncoding encoding, size_t framesPerBlock)
+	{
+		std::vector<uint8_t> result;
+
+		if (!IsAdpcm(encoding))
+		{
+			return result;
+		}
+
+		auto coefficientsSize = encoding == SampleEncoding::MsAdpcm ? sizeof(uint16_t) + sizeof(msAdpcmCoefficients) : 0;
+
+		WaveFormatAdpcm extension;
+		extension.extensionSize = static_cast<uint16_t>(sizeof(extension.samplesPerBlock) + coefficientsSize);
+		extension.samplesPerBlock = static_cast<uint16_t>(framesPerBlock);
+
+		result.resize(sizeof(extension) + coefficientsSize);
+		std::memcpy(result.data(), &extension, sizeof(extension));
+
+		if (coefficientsSize != 0)
+		{
+			auto count = static_cast<uint16_t>(msAdpcmCoefficientsCount);
+			std::memcpy(result.data() + sizeof(extension), &count, sizeof(count));
+			std::memcpy(result.data() + sizeof(extension) + sizeof(count), msAdpcmCoefficients, sizeof(msAdpcmCoefficients));
+		}
+
+		return result;
+	}
+
+	template<typename T>
+	void Append(std::vector<uint8_t>& bytes, const T& value)
+	{
+		auto begin = reinterpret_cast<const uint8_t*>(&value);
+		bytes.insert(bytes.end(), begin, begin + sizeof(value));
+	}
+
+	void AppendTag(std::vector<uint8_t>& bytes, const char* tag)
+	{
+		bytes.insert(bytes.end(), tag, tag + 4);
+	}
+
+	void AppendWave64Guid(std::vector<uint8_t>& bytes, const char* fourCC)
+	{
+		uint8_t guid[16];
+		MakeWave64Guid(fourCC, guid);
+		bytes.insert(bytes.end(), guid, guid + sizeof(guid));
+	}
+
+	void AlignWave64(std::vector<uint8_t>& bytes)
+	{
+		bytes.resize((bytes.size() + wave64Alignment - 1) / wave64Alignment * wave64Alignment);
+	}
+}
+
+class WaveWriter::Impl
+{
+public:
+	void WriteBuffer()
+	{
+		if (!buffer.empty())
+		{
+			file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+			buffer.clear();
+		}
+	}
+
+	template<typename T>
+	void Patch(uint64_t offset, const T& value)
+	{
+		file.seekp(static_cast<std::streamoff>(offset));
+		file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	void PatchTag(uint64_t offset, const char* tag)
+	{
+		file.seekp(static_cast<std::streamoff>(offset));
+		file.write(tag, 4);
+	}
+
+	void PatchHeader(uint64_t paddedDataSize)
+	{
+		auto framesCount = GetFramesCount();
+
+		if (container == WaveContainer::Wave64)
+		{
+			Patch(riffSizeOffset, headerSize + paddedDataSize);
+			Patch(dataSizeOffset, wave64ChunkHeaderSize + dataSize);
+
+			if (factOffset != 0)
+			{
+				Patch(factOffset, framesCount);
+			}
+		}
+		else
+		{
+			uint64_t riffSize = headerSize - 8 + paddedDataSize;
+
+			// The JUNK chunk reserved the room for ds64, so the file becomes RF64 in place
+			if (riffSize > std::numeric_limits<uint32_t>::max())
+			{
+				container = WaveContainer::Rf64;
+			}
+
+			if (container == WaveContainer::Rf64)
+			{
+				uint64_t ds64[] = { riffSize, dataSize, framesCount };
+
+				PatchTag(0, "RF64");
+				Patch(riffSizeOffset, rf64SizePlaceholder);
+				PatchTag(ds64Offset - 8, "ds64");
+				Patch(ds64Offset, ds64);
+				Patch(dataSizeOffset, rf64SizePlaceholder);
+			}
+			else
+			{
+				Patch(riffSizeOffset, static_cast<uint32_t>(riffSize));
+				Patch(dataSizeOffset, static_cast<uint32_t>(dataSize));
+			}
+
+			if (factOffset != 0)
+			{
+				Patch(factOffset, static_cast<uint32_t>(std::min<uint64_t>(framesCount, std::numeric_limits<uint32_t>::max())));
+			}
+		}
+
+		file.seekp(0, std::ios::end);
+	}
+
+	void Flush()
+	{
+		WriteBuffer();
+		PatchHeader(dataSize);
+		file.flush();
+		flushedDataSize = dataSize;
+
+		if (!file.good())
+		{
+			throw std::runtime_error("Failed to write the file");
+		}
+	}
+
+	uint64_t GetFramesCount() const
+	{
+		return ::GetFramesCount(encoding, channelsCount, bitsPerSample, blockAlign, dataSize);
+	}
+
+	std::ofstream file;
+	size_t channelsCount;
+	size_t bitsPerSample;
+	size_t sampleRate;
+	SampleEncoding encoding;
+	size_t blockAlign;
+	size_t framesPerBlock;
+	WaveContainer container;
+	std::vector<uint8_t> buffer;
+	size_t bufferSize;
+	uint64_t headerSize;
+	uint64_t riffSizeOffset;
+	uint64_t ds64Offset;
+	uint64_t factOffset;
+	uint64_t dataSizeOffset;
+	uint64_t dataSize;
+	uint64_t flushedDataSize;
+	uint64_t flushInterval;
+};
+
+WaveWriter::WaveWriter(
+	const char* filename,
+	size_t channelsCount, size_t bitsPerSample, size_t sampleRate,
+	SampleEncoding encoding,
+	size_t blockAlign,
+	WaveContainer container,
+	size_t bufferSize) :
+	m_d(std::make_unique<Impl>())
+{
+	if (channelsCount == 0 || bitsPerSample == 0 || sampleRate == 0)
+	{
+		throw std::invalid_argument("Invalid wave format");
+	}
+
+	size_t framesPerBlock = 1;
+
+	if (IsAdpcm(encoding))
+	{
+		blockAlign = blockAlign == 0 ? GetDefaultAdpcmBlockAlign(encoding, channelsCount) : blockAlign;
+		framesPerBlock = GetAdpcmFramesPerBlock(encoding, channelsCount, blockAlign);
+
+		if (framesPerBlock == 0)
+		{
+			throw std::invalid_argument("Invalid ADPCM block layout");
+		}
+	}
+	else
+	{
+		blockAlign = channelsCount * bitsPerSample / 8;
+	}
+
+	m_d->file.open(filename,
+		std::ios::binary |
+		std::ios::out |
+		std::ios::trunc);
+
+	if (!m_d->file.is_open())
+	{
+		throw std::runtime_error("Could not create the file");
+	}
+
+	m_d->channelsCount = channelsCount;
+	m_d->bitsPerSample = bitsPerSample;
+	m_d->sampleRate = sampleRate;
+	m_d->encoding = encoding;
+	m_d->blockAlign = blockAlign;
+	m_d->framesPerBlock = framesPerBlock;
+	m_d->container = container;
+	m_d->bufferSize = bufferSize;
+	m_d->buffer.reserve(bufferSize);
+	m_d->dataSize = 0;
+	m_d->flushedDataSize = 0;
+	m_d->flushInterval = 0;
+
+	auto extension = MakeFormatExtension(encoding, framesPerBlock);
+
+	WaveFormat format;
+	format.audioFormat = ToWaveFormatTag(encoding);
+	format.numChannels = static_cast<uint16_t>(channelsCount);
+	format.sampleRate = static_cast<uint32_t>(sampleRate);
+	format.byteRate = static_cast<uint32_t>(sampleRate * blockAlign / framesPerBlock);
+	format.blockAlign = static_cast<uint16_t>(blockAlign);
+	format.bitsPerSample = static_cast<uint16_t>(bitsPerSample);
+
+	// The header is the start of the first write, the sizes are patched in later
+	auto& header = m_d->buffer;
+	auto fmtSize = sizeof(format) + extension.size();
+	auto hasFact = encoding == SampleEncoding::MuLaw || IsAdpcm(encoding);
+	m_d->ds64Offset = 0;
+	m_d->factOffset = 0;
+
+	if (container == WaveContainer::Wave64)
+	{
+		uint64_t placeholder = 0;
+
+		header.insert(header.end(), wave64RiffGuid, wave64RiffGuid + sizeof(wave64RiffGuid));
+		m_d->riffSizeOffset = header.size();
+		Append(header, placeholder);
+		header.insert(header.end(), wave64WaveGuid, wave64WaveGuid + sizeof(wave64WaveGuid));
+
+		AppendWave64Guid(header, "fmt ");
+		Append(header, static_cast<uint64_t>(wave64ChunkHeaderSize + fmtSize));
+		Append(header, format);
+		header.insert(header.end(), extension.begin(), extension.end());
+		AlignWave64(header);
+
+		if (hasFact)
+		{
+			AppendWave64Guid(header, "fact");
+			Append(header, static_cast<uint64_t>(wave64ChunkHeaderSize + sizeof(uint64_t)));
+			m_d->factOffset = header.size();
+			Append(header, placeholder);
+		}
+
+		AppendWave64Guid(header, "data");
+		m_d->dataSizeOffset = header.size();
+		Append(header, placeholder);
+	}
+	else
+	{
+		uint32_t placeholder = 0;
+
+		AppendTag(header, container == WaveContainer::Rf64 ? "RF64" : "RIFF");
+		m_d->riffSizeOffset = header.size();
+		Append(header, placeholder);
+		AppendTag(header, "WAVE");
+
+		// Room for a ds64 chunk, in case the file outgrows 32-bit sizes
+		AppendTag(header, container == WaveContainer::Rf64 ? "ds64" : "JUNK");
+		Append(header, ds64Size);
+		m_d->ds64Offset = header.size();
+		header.resize(header.size() + ds64Size);
+
+		AppendTag(header, "fmt ");
+		Append(header, static_cast<uint32_t>(fmtSize));
+		Append(header, format);
+		header.insert(header.end(), extension.begin(), extension.end());
+
+		// Compressed formats need the frames count in a fact chunk
+		if (hasFact)
+		{
+			AppendTag(header, "fact");
+			Append(header, static_cast<uint32_t>(sizeof(uint32_t)));
+			m_d->factOffset = header.size();
+			Append(header, placeholder);
+		}
+
+		AppendTag(header, "data");
+		m_d->dataSizeOffset = header.size();
+		Append(header, placeholder);
+	}
+
+	m_d->headerSize = header.size();
+	m_d->Flush();
+}
+
+WaveWriter::~WaveWriter()
+{
+	try
+	{
+		Close();
+	}
+	catch (...)
+	{
+	}
+}
+
+void WaveWriter::Write(const void* data, size_t size)
+{
+	if (!m_d->file.is_open())
+	{
+		throw std::logic_error("The wave writer is closed");
+	}
+
+	if (IsAdpcm(m_d->encoding) && size % m_d->blockAlign != 0)
+	{
+		throw std::invalid_argument("ADPCM samples have to be written in whole blocks");
+	}
+
+	auto bytes = static_cast<const uint8_t*>(data);
+
+	if (m_d->buffer.size() + size > m_d->bufferSize)
+	{
+		m_d->WriteBuffer();
+	}
+
+	// Blocks as large as the buffer skip it
+	if (size >= m_d->bufferSize)
+	{
+		m_d->file.write(reinterpret_cast<const char*>(bytes), size);
+	}
+	else
+	{
+		m_d->buffer.insert(m_d->buffer.end(), bytes, bytes + size);
+	}
+
+	m_d->dataSize += size;
+
+	if (!m_d->file.good())
+	{
+		throw std::runtime_error("Failed to write the file");
+	}
+
+	if (m_d->flushInterval != 0 && m_d->dataSize - m_d->flushedDataSize >= m_d->flushInterval)
+	{
+		m_d->Flush();
+	}
+}
+
+void WaveWriter::Flush()
+{
+	if (m_d->file.is_open())
+	{
+		m_d->Flush();
+	}
+}
+
+void WaveWriter::SetFlushInterval(double seconds)
+{
+	auto blocks = seconds * m_d->sampleRate / m_d->framesPerBlock;
+	m_d->flushInterval = blocks > 0 ? static_cast<uint64_t>(blocks + 1) * m_d->blockAlign : 0;
+}
+
+void WaveWriter::Close()
+{
+	if (!m_d->file.is_open())
+	{
+		return;
+	}
+
+	m_d->WriteBuffer();
+
+	// Chunks are padded to the container's alignment, the data chunk keeps its own size
+	uint64_t alignment = m_d->container == WaveContainer::Wave64 ? wave64Alignment : 2;
+	uint64_t paddedDataSize = m_d->dataSize;
+	while (paddedDataSize % alignment != 0)
+	{
+		m_d->file.put(0);
+		++paddedDataSize;
+	}
+
+	m_d->PatchHeader(paddedDataSize);
+	m_d->file.close();
+
+	if (m_d->file.fail())
+	{
+		throw std::runtime_error("Failed to write the file");
+	}
+}
+
+uint64_t WaveWriter::GetFramesCount() const
+{
+	return m_d->GetFramesCount();
+}
+
+uint64_t WaveWriter::GetDataSize() const
+{
+	return m_d->dataSize;
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include <algorithm>
+
+#include "WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool(size_t threadsCount) :
+	m_nextQueue(0),
+	m_pending(0),
+	m_exit(false)
+{
+	if (threadsCount == 0)
+	{
+		threadsCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	}
+
+	for (size_t i = 0; i < threadsCount; ++i)
+	{
+		m_queues.push_back(std::make_unique<Queue>());
+	}
+
+	for (size_t i = 0; i < threadsCount; ++i)
+	{
+		m_threads.emplace_back([this, i]()
+		{
+			Run(i);
+		});
+	}
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_wakeMutex);
+		m_exit = true;
+	}
+
+	m_wakeUp.notify_all();
+
+	// Queued tasks are destroyed outside the locks, their captures may do anything
+	std::vector<std::deque<Task>> dropped;
+	for (auto& queue : m_queues)
+	{
+		std::lock_guard<std::mutex> guard(queue->mutex);
+		dropped.push_back(std::move(queue->tasks));
+		queue->tasks.clear();
+	}
+
+	for (auto& thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+void WorkStealingPool::Submit(Task task)
+{
+	{
+		// Counted under the same lock, so a worker can't take the task before it is counted
+		std::lock_guard<std::mutex> guard(m_wakeMutex);
+		auto& queue = *m_queues[m_nextQueue++ % m_queues.size()];
+
+		std::lock_guard<std::mutex> queueGuard(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+		++m_pending;
+	}
+
+	m_wakeUp.notify_one();
+}
+
+size_t WorkStealingPool::GetThreadsCount() const
+{
+	return m_threads.size();
+}
+
+bool WorkStealingPool::TryPop(size_t worker, Task& task)
+{
+	auto& queue = *m_queues[worker];
+	std::lock_guard<std::mutex> guard(queue.mutex);
+
+	if (queue.tasks.empty())
+	{
+		return false;
+	}
+
+	task = std::move(queue.tasks.back());
+	queue.tasks.pop_back();
+
+	return true;
+}
+
+bool WorkStealingPool::TrySteal(size_t worker, Task& task)
+{
+	for (size_t i = 1; i < m_queues.size(); ++i)
+	{
+		auto& queue = *m_queues[(worker + i) % m_queues.size()];
+		std::lock_guard<std::mutex> guard(queue.mutex);
+
+		if (!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WorkStealingPool::Run(size_t worker)
+{
+	while (true)
+	{
+		Task task;
+
+		if (TryPop(worker, task) || TrySteal(worker, task))
+		{
+			{
+				std::lock_guard<std::mutex> guard(m_wakeMutex);
+				--m_pending;
+
+				// A task taken while the pool shuts down is dropped like the queued ones
+				if (m_exit)
+				{
+					return;
+				}
+			}
+
+			task();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+		m_wakeUp.wait(lock, [this]() { return m_exit || m_pending != 0; });
+
+		if (m_exit)
+		{
+			return;
+		}
+	}
+}
\ No newline at end of file
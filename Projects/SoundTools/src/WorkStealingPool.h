@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque. A worker takes its newest
+// task first and steals the oldest ones of the others when it runs out, so a few slow
+// tasks don't leave the rest of the cores idle. Tasks must not throw.
+class WorkStealingPool
+{
+public:
+	using Task = std::function<void()>;
+
+	// Zero threadsCount makes one thread per core
+	WorkStealingPool(size_t threadsCount = 0);
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	// Waits for running tasks, queued ones are dropped
+	~WorkStealingPool();
+
+	// Safe from any thread, including the workers
+	void Submit(Task task);
+
+	size_t GetThreadsCount() const;
+
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	bool TryPop(size_t worker, Task& task);
+	bool TrySteal(size_t worker, Task& task);
+	void Run(size_t worker);
+
+	std::vector<std::unique_ptr<Queue>> m_queues;
+	std::vector<std::thread> m_threads;
+	size_t m_nextQueue;
+	// Queued tasks that no worker has taken yet
+	size_t m_pending;
+	bool m_exit;
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wakeUp;
+};
\ No newline at end of file
@@ -1,140 +1,64 @@
 #include "RunApplication.h"
 
 #include <algorithm>
+#include <chrono>
 #include <exception>
+#include <functional>
 #include <future>
+#include <map>
+#include <mutex>
 #include <string>
 #include <sstream>
+#include <thread>
 #include <vector>
 
-#include "ScopedThread.h"
-#include "SoundTools/SoundDevice.h"
-#include "SoundTools/SoundContext.h"
-#include "SoundTools/SoundBuffer.h"
+#include "SoundTools/OscillatorGenerator.h"
+#include "SoundTools/Sequencer.h"
+#include "SoundTools/SoundCaptureDevice.h"
+#include "SoundTools/SoundServer.h"
 #include "SoundTools/SoundSource.h"
-#include "SoundTools/WaveBuffer.h"
+#include "SoundTools/WaveWriter.h"
 #include "ThreadSafeStreams.h"
 
 namespace
 {
-	class SoundObject
-	{
-	public:
-		SoundObject(const char* name) :
-			m_name(name),
-			m_buffer(WaveBuffer(name).MakeSoundBuffer())
-		{
-			m_source.SetBuffer(&m_buffer);
-		}
-		SoundObject(
-			const char* name,
-			const WaveBuffer& waveBuffer) :
-			m_name(name),
-			m_buffer(waveBuffer.MakeSoundBuffer())
-		{
-			m_source.SetBuffer(&m_buffer);
-		}
-		SoundObject(SoundObject&&) = default;
-		SoundObject(const SoundObject&) = delete;
-
-		const SoundBuffer& GetBuffer() const { return m_buffer; }
-		SoundSource& GetSource() { return m_source; }
-		const SoundSource& GetSource() const { return m_source; }
-
-		const char* GetName() const { return m_name.c_str(); }
-
-		SoundObject& operator=(SoundObject&&) = default;
-		SoundObject& operator=(const SoundObject&) = delete;
-
-	private:
-		std::string m_name;
-		SoundBuffer m_buffer;
-		SoundSource m_source;
-	};
-
-	template<size_t n>
-	struct SizeToType;
-
-	template<>
-	struct SizeToType<1>
-	{
-		using Type = uint8_t;
-		using Bigger = uint16_t;
-	};
-
-	template<>
-	struct SizeToType<2>
-	{
-		using Type = uint16_t;
-		using Bigger = uint32_t;
-	};
-
-	template<size_t bytesPerSample>
-	decltype(auto) ComputeNoteSample(float frequency, size_t nSample, size_t sampleRate)
-	{
-		using T = typename SizeToType<bytesPerSample>::Type;
-		using Bigger = typename SizeToType<bytesPerSample>::Bigger;
-
-		constexpr auto max = std::numeric_limits<T>::max();
-		constexpr auto max_2f = static_cast<float>(max) * .5f;
-
-		auto biggerResult = 
-			static_cast<Bigger>(
-				max_2f * (std::sin((nSample * frequency * 2.f * 3.14159f) / (sampleRate)) + 1.f));
-
-		biggerResult = std::max<Bigger>(  0, biggerResult);
-		biggerResult = std::min<Bigger>(max, biggerResult);
-
-		return static_cast<T>(biggerResult);
-	}
-
-
-	template<size_t bytesPerSample>
-	WaveBuffer MakeNoteBuffer(float frequency, float duration, size_t sampleRate)
-	{
-		using T = typename SizeToType<bytesPerSample>::Type;
-
-		// Compute buffer size
-		auto samplesCount = static_cast<size_t>(duration * sampleRate);
-		auto bytesCount = samplesCount * bytesPerSample;
-
-		// Allocate the buffer
-		std::unique_ptr<uint8_t[]> buffer;
-		buffer.reset(new uint8_t[bytesCount]);
-
-		auto raw = reinterpret_cast<T*>(buffer.get());
-
-		for (size_t i = 0; i < samplesCount; ++i)
-		{
-			raw[i] = ComputeNoteSample<bytesPerSample>(frequency, i, sampleRate);
-		}
-
-		return WaveBuffer(1, bytesPerSample * 8, sampleRate, std::move(buffer), bytesCount);
-	}
-
 	void RunApplicationSafe(ThreadSafeIStream& input, ThreadSafeOStream& output)
 	{
 		try
 		{
-			SoundDevice device;
-			SoundContext context(&device);
-
-			context.SetCurrent();
+			std::mutex soundsMutex;
+			std::map<std::string, uint64_t> sounds;
 
-			std::vector<SoundObject> sounds;
+			// Declared last so the server thread is stopped before the names map goes away
+			SoundServer server(nullptr, [&](uint64_t, const char* message)
+			{
+				output << message << std::endl;
+			});
 
-			auto findSound = [&](const char* name)
-				-> SoundObject*
+			auto startSound = [&](const std::string& name, const std::function<uint64_t(SoundCompletionCallback)>& play)
 			{
-				for (auto& sound : sounds)
+				// Completions wait for the lock, so the id is registered before it can finish
+				std::lock_guard<std::mutex> guard(soundsMutex);
+				sounds[name] = play([&, name](uint64_t id)
 				{
-					if (std::strcmp(sound.GetName(), name) == 0)
+					std::lock_guard<std::mutex> guard(soundsMutex);
+					auto it = sounds.find(name);
+
+					// The name may already belong to a newer sound
+					if (it != sounds.end() && it->second == id)
 					{
-						return &sound;
+						sounds.erase(it);
 					}
-				}
 
-				return nullptr;
+					output << "deleting " << name << std::endl;
+				});
+			};
+			auto findSound = [&](const std::string& name)
+				-> uint64_t
+			{
+				std::lock_guard<std::mutex> guard(soundsMutex);
+				auto it = sounds.find(name);
+				return it != sounds.end() ? it->second : 0;
 			};
 			auto soundNotFoundMessage = [&](const char* name)
 			{
@@ -159,58 +83,52 @@ namespace
 				if (tmp == "play")
 				{
 					std::getline(lineStream, tmp);
-
-					try
-					{
-						sounds.emplace_back(tmp.c_str());
-						sounds.back().GetSource().Play();
-					}
-					catch (const std::exception& ex)
+					startSound(tmp, [&](SoundCompletionCallback onComplete)
 					{
-						output << ex.what() << std::endl;
-					}
+						return server.Play(tmp.c_str(), false, std::move(onComplete));
+					});
 				}
 				else if (tmp == "pause")
 				{
 					std::getline(lineStream, tmp);
-					auto sound = findSound(tmp.c_str());
+					auto id = findSound(tmp);
 
-					if (sound == nullptr)
+					if (id == 0)
 					{
 						soundNotFoundMessage(tmp.c_str());
 					}
 					else
 					{
-						sound->GetSource().Pause();
+						server.Pause(id);
 					}
 				}
 				else if (tmp == "stop")
 				{
 					std::getline(lineStream, tmp);
-					auto sound = findSound(tmp.c_str());
+					auto id = findSound(tmp);
 
-					if (sound == nullptr)
+					if (id == 0)
 					{
 						soundNotFoundMessage(tmp.c_str());
 					}
 					else
 					{
-						sound->GetSource().Stop();
+						server.Stop(id);
 					}
 				}
 				else if (tmp == "state")
 				{
 					std::getline(lineStream, tmp);
-					auto sound = findSound(tmp.c_str());
+					auto id = findSound(tmp);
 
-					if (sound == nullptr)
+					if (id == 0)
 					{
 						soundNotFoundMessage(tmp.c_str());
 					}
 					else
 					{
 						const char* stateStr = nullptr;
-						switch (sound->GetSource().GetState())
+						switch (server.GetState(id).get())
 						{
 						case SoundSourceState::Initial:
 							stateStr = "Initial";
@@ -232,36 +150,35 @@ namespace
 				else if (tmp == "resume")
 				{
 					std::getline(lineStream, tmp);
-					auto sound = findSound(tmp.c_str());
+					auto id = findSound(tmp);
 
-					if (sound == nullptr)
+					if (id == 0)
 					{
 						soundNotFoundMessage(tmp.c_str());
 					}
 					else
 					{
-						sound->GetSource().Play();
+						server.Resume(id);
 					}
 				}
 				else if (tmp == "repeat")
 				{
 					lineStream >> tmp;
-					auto sound = findSound(tmp.c_str());
+					auto id = findSound(tmp);
 
-					if (sound == nullptr)
+					if (id == 0)
 					{
-						sounds.emplace_back(tmp.c_str());
-						sound = &sounds.back();
-
-						sound->GetSource().SetLooping(true);
-						sound->GetSource().Play();
+						startSound(tmp, [&](SoundCompletionCallback onComplete)
+						{
+							return server.Play(tmp.c_str(), true, std::move(onComplete));
+						});
 					}
 					else
 					{
 						skipSpaces();
 						std::getline(lineStream, tmp);
 						std::transform(tmp.begin(), tmp.end(), tmp.begin(), ::tolower);
-						sound->GetSource().SetLooping(tmp == "true");
+						server.SetLooping(id, tmp == "true");
 					}
 				}
 				else if (tmp == "note")
@@ -273,47 +190,91 @@ namespace
 					sstr << freq << ' ' << duration;
 					auto sname = sstr.str();
 
-					auto sampleRate = 11025;
-					auto buffer = MakeNoteBuffer<1>(freq, duration, sampleRate);
-					sounds.emplace_back(sname.c_str(), buffer);
-					auto sound = &sounds.back();
-
-					sound->GetSource().Play();
+					// Synthesized while it plays, a long note costs no more memory than a short one
+					auto generator = std::make_unique<OscillatorGenerator>(44100, duration);
+					generator->GetBank().Add(Waveform::Sine, freq, .5f);
+					startSound(sname, [&](SoundCompletionCallback onComplete)
+					{
+						return server.Play(std::move(generator), false, std::move(onComplete));
+					});
 				}
-				else
+				else if (tmp == "score")
 				{
-					system(line.c_str());
-				}
-			};
+					std::getline(lineStream, tmp);
 
-			ScopedThread scopedThread([&](bool& finished, std::mutex& mutex)
-			{
-				auto isFinished = [&]()
+					// Events are rendered on their exact frames, the server thread timing doesn't matter
+					auto sequencer = std::make_unique<Sequencer>(2, 44100);
+
+					try
+					{
+						sequencer->LoadScore(tmp.c_str());
+					}
+					catch (const std::exception& ex)
+					{
+						output << ex.what() << std::endl;
+						return;
+					}
+
+					startSound(tmp, [&](SoundCompletionCallback onComplete)
+					{
+						return server.Play(std::move(sequencer), false, std::move(onComplete));
+					});
+				}
+				else if (tmp == "preload")
 				{
-					std::lock_guard<std::mutex> guard(mutex);
-					return finished;
-				};
+					std::vector<std::string> names;
+					while (lineStream >> tmp)
+					{
+						names.push_back(tmp);
+					}
+
+					std::vector<const char*> filenames;
+					for (auto& name : names)
+					{
+						filenames.push_back(name.c_str());
+					}
 
-				while (!isFinished())
+					auto loaded = server.Preload(filenames.data(), filenames.size()).get();
+					output << "preloaded " << loaded << " of " << names.size() << std::endl;
+				}
+				else if (tmp == "record")
 				{
-					using namespace std::chrono_literals;
-					std::this_thread::sleep_for(3s);
+					double duration;
+					lineStream >> duration;
+					skipSpaces();
+					std::getline(lineStream, tmp);
 
-					sounds.erase(
-						std::remove_if(sounds.begin(), sounds.end(),
-							[&](const SoundObject& sound)
+					try
 					{
-						if (sound.GetSource().GetState() == SoundSourceState::Stopped)
+						SoundRenderFormat format = { 1, 16, 44100, SampleEncoding::Pcm };
+						SoundCaptureDevice capture(format);
+						WaveWriter writer(tmp.c_str(), format.channelsCount, format.bitsPerSample, format.sampleRate);
+
+						// The ring holds seconds of audio, the file is written in its own time
+						capture.Start();
+						auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(duration);
+						while (std::chrono::steady_clock::now() < end)
 						{
-							output << "deleting " << sound.GetName() << std::endl;
-							return true;
+							std::this_thread::sleep_for(std::chrono::milliseconds(50));
+							capture.Read(writer);
 						}
 
-						return false;
-					}), sounds.end());
-				}
-			});
+						capture.Stop();
+						capture.Read(writer);
+						writer.Close();
 
+						output << "recorded " << writer.GetFramesCount() << " frames, dropped " << capture.GetDroppedFrames() << std::endl;
+					}
+					catch (const std::exception& ex)
+					{
+						output << ex.what() << std::endl;
+					}
+				}
+				else
+				{
+					system(line.c_str());
+				}
+			};
 
 			input.GetLine(line);
 